@@ -27,14 +27,7 @@ TValue kbytevector_new_bs_g(klisp_State *K, bool m, const uint8_t *buf,
 /* LOCK: GIL should be acquired */
 static uint32_t get_bytevector_hash(const uint8_t *buf, uint32_t size)
 {
-    uint32_t h = size; /* seed */
-    size_t step = (size>>5)+1; /* if bytevector is too long, don't hash all 
-                                  its bytes */
-    size_t size1;
-    for (size1 = size; size1 >= step; size1 -= step)  /* compute hash */
-        h = h ^ ((h<<5)+(h>>2)+ buf[size1-1]);
-
-    return h;
+    return klispS_hash(buf, size);
 }
 
 /* Looks for a bytevector in the stringtable and returns a pointer
@@ -43,8 +36,7 @@ static Bytevector *search_in_bb_table(klisp_State *K, const uint8_t *buf,
                                       uint32_t size, uint32_t h)
 {
 
-    for (GCObject *o = G(K)->strt.hash[lmod(h, G(K)->strt.size)];
-         o != NULL; o = o->gch.next) {
+    for (GCObject *o = klispS_chain(K, h); o != NULL; o = o->gch.next) {
         klisp_assert(o->gch.tt == K_TKEYWORD || o->gch.tt == K_TSYMBOL || 
                      o->gch.tt == K_TSTRING || o->gch.tt == K_TBYTEVECTOR);
 		        
@@ -103,18 +95,8 @@ TValue kbytevector_new_bs_imm(klisp_State *K, const uint8_t *buf, uint32_t size)
     }
     
     /* add to the string/symbol table (and link it) */
-    stringtable *tb;
-    tb = &G(K)->strt;
-    h = lmod(h, tb->size);
-    new_bb->next = tb->hash[h];  /* chain new entry */
-    tb->hash[h] = (GCObject *)(new_bb);
-    tb->nuse++;
     TValue ret_tv = gc2bytevector(new_bb);
-    if (tb->nuse > ((uint32_t) tb->size) && tb->size <= INT32_MAX / 2) {
-        krooted_tvs_push(K, ret_tv); /* save in case of gc */
-        klispS_resize(K, tb->size*2);  /* too crowded */
-        krooted_tvs_pop(K);
-    }
+    klispS_add(K, ret_tv, h);
 
     return ret_tv;
 }
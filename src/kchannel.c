@@ -0,0 +1,188 @@
+/*
+** kchannel.c
+** Kernel Channels
+** See Copyright Notice in klisp.h
+*/
+
+#include "kobject.h"
+#include "kstate.h"
+#include "kchannel.h"
+#include "kvector.h"
+#include "kpair.h"
+#include "kmem.h"
+#include "kgc.h"
+#include "kerror.h"
+
+/* GC: Assumes nothing */
+TValue kmake_channel(klisp_State *K, uint32_t capacity) 
+{
+    TValue buf = kvector_new_sf(K, capacity == 0? MINCHANNELSIZE : capacity,
+                                KINERT);
+    krooted_tvs_push(K, buf);
+    Channel *new_channel = klispM_new(K, Channel);
+
+    /* header + gc_fields */
+    klispC_link(K, (GCObject *) new_channel, K_TCHANNEL, 0);
+
+    /* channel specific fields */
+    new_channel->buf = buf;
+    new_channel->capacity = capacity;
+    new_channel->head = 0;
+    new_channel->count = 0;
+    krooted_tvs_pop(K);
+
+    /* XXX no attrs for now */
+    int32_t res = pthread_cond_init(&new_channel->not_empty, NULL);
+    if (res == 0) {
+        res = pthread_cond_init(&new_channel->not_full, NULL);
+        if (res != 0)
+            UNUSED(pthread_cond_destroy(&new_channel->not_empty));
+    }
+
+    if (res != 0) {
+        klispE_throw_simple_with_irritants(K, "Can't create channel", 1, 
+                                           i2tv(res));
+        return KNIL;
+    }
+    return gc2channel(new_channel);
+}
+
+bool kchannelp(TValue obj)
+{
+    return ttischannel(obj);
+}
+
+/* wake the threads that may be waiting for cond, and those in
+   channel-select */
+static inline void wake_waiters(klisp_State *K, pthread_cond_t *cond)
+{
+    int32_t ret = pthread_cond_signal(cond);
+    klisp_assert(ret == 0); /* shouldn't happen */
+    if (G(K)->chan_selecters > 0) {
+        ret = pthread_cond_broadcast(&G(K)->chancond);
+        klisp_assert(ret == 0); /* shouldn't happen */
+    }
+    UNUSED(ret);
+}
+
+/* GC: channel should be rooted */
+static void grow_buffer(klisp_State *K, TValue channel)
+{
+    Channel *ch = tv2channel(channel);
+    uint32_t size = kvector_size(ch->buf);
+    if (size > INT32_MAX / 2) {
+        klispE_throw_simple(K, "channel is too big");
+        return;
+    }
+    TValue new_buf = kvector_new_sf(K, size * 2, KINERT);
+    /* copy the queued objects in order, from the start of new_buf */
+    TValue *src = kvector_buf(ch->buf);
+    TValue *dst = kvector_buf(new_buf);
+    for (uint32_t i = 0, j = ch->head; i < ch->count; ++i) {
+        dst[i] = src[j];
+        if (++j == size)
+            j = 0;
+    }
+    ch->buf = new_buf;
+    ch->head = 0;
+}
+
+/* LOCK: GIL should be acquired exactly once */
+/* GC: channel & obj should be rooted */
+bool kchannel_try_send(klisp_State *K, TValue channel, TValue obj)
+{
+    Channel *ch = tv2channel(channel);
+    uint32_t size = kvector_size(ch->buf);
+
+    if (ch->count == size) {
+        if (ch->capacity != 0)
+            return false;
+        grow_buffer(K, channel);
+        size = kvector_size(ch->buf);
+    }
+
+    uint32_t i = ch->head + ch->count;
+    if (i >= size)
+        i -= size;
+    kvector_buf(ch->buf)[i] = obj;
+    ++ch->count;
+    wake_waiters(K, &ch->not_empty);
+    return true;
+}
+
+/* LOCK: GIL should be acquired exactly once */
+/* GC: channel should be rooted */
+bool kchannel_try_receive(klisp_State *K, TValue channel, TValue *obj)
+{
+    Channel *ch = tv2channel(channel);
+
+    if (ch->count == 0)
+        return false;
+
+    TValue *buf = kvector_buf(ch->buf);
+    *obj = buf[ch->head];
+    /* don't keep the object alive from the buffer */
+    buf[ch->head] = KINERT;
+    if (++ch->head == kvector_size(ch->buf))
+        ch->head = 0;
+    --ch->count;
+    wake_waiters(K, &ch->not_full);
+    return true;
+}
+
+/* LOCK: GIL should be acquired exactly once */
+/* GC: channel & obj should be rooted */
+void kchannel_send(klisp_State *K, TValue channel, TValue obj)
+{
+    while(!kchannel_try_send(K, channel, obj)) {
+        /* wait for a receive, this releases the GIL while blocked
+           and takes it back before returning */
+        int32_t ret = pthread_cond_wait(&tv2channel(channel)->not_full,
+                                        &G(K)->gil);
+        klisp_assert(ret == 0); /* shouldn't happen */
+        UNUSED(ret);
+    }
+}
+
+/* LOCK: GIL should be acquired exactly once */
+/* GC: channel should be rooted */
+TValue kchannel_receive(klisp_State *K, TValue channel)
+{
+    TValue obj;
+    while(!kchannel_try_receive(K, channel, &obj)) {
+        /* wait for a send, this releases the GIL while blocked
+           and takes it back before returning */
+        int32_t ret = pthread_cond_wait(&tv2channel(channel)->not_empty,
+                                        &G(K)->gil);
+        klisp_assert(ret == 0); /* shouldn't happen */
+        UNUSED(ret);
+    }
+    return obj;
+}
+
+/* LOCK: GIL should be acquired exactly once */
+/* GC: ls should be rooted */
+TValue kchannel_select(klisp_State *K, TValue ls, TValue *obj)
+{
+    while(true) {
+        /* the channels are tried in order */
+        for (TValue tail = ls; !ttisnil(tail); tail = kcdr(tail)) {
+            TValue channel = kcar(tail);
+            if (kchannel_try_receive(K, channel, obj))
+                return channel;
+        }
+        /* wait for a send on any channel */
+        ++G(K)->chan_selecters;
+        int32_t ret = pthread_cond_wait(&G(K)->chancond, &G(K)->gil);
+        --G(K)->chan_selecters;
+        klisp_assert(ret == 0); /* shouldn't happen */
+        UNUSED(ret);
+    }
+}
+
+void klispCh_free(klisp_State *K, Channel *ch)
+{
+    UNUSED(pthread_cond_destroy(&ch->not_empty));
+    UNUSED(pthread_cond_destroy(&ch->not_full));
+    klispM_free(K, ch);
+}
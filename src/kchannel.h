@@ -0,0 +1,38 @@
+/*
+** kchannel.h
+** Kernel Channels
+** See Copyright Notice in klisp.h
+*/
+
+#ifndef kchannel_h
+#define kchannel_h
+
+#include "kobject.h"
+#include "kstate.h"
+
+/* capacity 0 means unbounded */
+TValue kmake_channel(klisp_State *K, uint32_t capacity);
+void klispCh_free(klisp_State *K, Channel *channel);
+
+bool kchannelp(TValue obj);
+
+/* LOCK: these functions require that the calling code has 
+   acquired the GIL exactly once previous to the call.  The blocking
+   ones release it while waiting */
+/* GC: channel & obj should be rooted */
+bool kchannel_try_send(klisp_State *K, TValue channel, TValue obj);
+/* GC: channel should be rooted */
+bool kchannel_try_receive(klisp_State *K, TValue channel, TValue *obj);
+/* GC: channel & obj should be rooted */
+void kchannel_send(klisp_State *K, TValue channel, TValue obj);
+/* GC: channel should be rooted */
+TValue kchannel_receive(klisp_State *K, TValue channel);
+/* ls should be a finite non empty list of channels, returns the
+   channel the object in obj was received from */
+/* GC: ls should be rooted */
+TValue kchannel_select(klisp_State *K, TValue ls, TValue *obj);
+
+#define kchannel_capacity(c_) (tv2channel(c_)->capacity)
+#define kchannel_count(c_) (tv2channel(c_)->count)
+
+#endif
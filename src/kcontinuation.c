@@ -222,6 +222,7 @@ void do_interception(klisp_State *K)
         /* all interceptors returned normally */
         /* this is a normal pass/not subject to interception */
         kset_cc(K, dst_cont);
+        klispT_restore_kd_bindings(K, dst_cont);
         kapply_cc(K, obj);
     } else {
         /* call the operative with the passed obj and applicative
@@ -243,6 +244,8 @@ void do_interception(klisp_State *K)
                                              2, kcdr(ls), dst_cont);
         kset_cc(K, new_cont);
         krooted_tvs_pop(K);
+        /* the interceptor is called in the dynamic extent of outer */
+        klispT_restore_kd_bindings(K, outer);
         /* XXX: what to pass as si? */
         ktail_call(K, op, ptree, denv);
     }
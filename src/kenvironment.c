@@ -190,6 +190,29 @@ void kadd_binding(klisp_State *K, TValue env, TValue sym, TValue val)
     }
 }
 
+/* GC: Assumes that env, sym & val are rooted. */
+void kadd_new_binding(klisp_State *K, TValue env, TValue sym, TValue val)
+{
+    klisp_assert(ttisenvironment(env));
+    klisp_assert(ttissymbol(sym));
+
+#if KTRACK_NAMES
+    ktry_set_name(K, val, sym);
+#endif
+
+    TValue bindings = kenv_bindings(K, env);
+    if (ttistable(bindings)) {
+        TValue *cell = klispH_setsym(K, tv2table(bindings), tv2sym(sym));
+        *cell = val;
+    } else {
+        klisp_assert(ttisnil(kfind_local_binding(K, bindings, sym)));
+        TValue new_pair = kcons(K, sym, val);
+        krooted_tvs_push(K, new_pair);
+        kenv_bindings(K, env) = kcons(K, new_pair, bindings);
+        krooted_tvs_pop(K);
+    }
+}
+
 /* This works no matter if parents is a list or a single environment */
 /* GC: assumes env & sym are rooted */
 static inline bool try_get_binding(klisp_State *K, TValue env, TValue sym, 
@@ -14,6 +14,9 @@
 TValue kmake_environment(klisp_State *K, TValue parents);
 #define kmake_empty_environment(kst_) (kmake_environment(kst_, KNIL))
 void kadd_binding(klisp_State *K, TValue env, TValue sym, TValue val);
+/* like kadd_binding but sym must not be already bound in env (e.g. env
+   is new and sym comes from a ptree checked by check_copy_ptree) */
+void kadd_new_binding(klisp_State *K, TValue env, TValue sym, TValue val);
 TValue kget_binding(klisp_State *K, TValue env, TValue sym);
 bool kbinds(klisp_State *K, TValue env, TValue sym);
 /* keyed dynamic vars */
@@ -0,0 +1,70 @@
+/*
+** kfuture.c
+** Kernel Futures
+** See Copyright Notice in klisp.h
+*/
+
+#include "kobject.h"
+#include "kstate.h"
+#include "kfuture.h"
+#include "kmem.h"
+#include "kgc.h"
+#include "kerror.h"
+
+TValue kmake_future(klisp_State *K) 
+{
+    Future *new_future = klispM_new(K, Future);
+
+    /* header + gc_fields */
+    klispC_link(K, (GCObject *) new_future, K_TFUTURE, 0);
+
+    /* future specific fields */
+    new_future->value = KINERT;
+    new_future->state = KFUTURE_PENDING;
+
+    /* XXX no attrs for now */
+    int32_t res = pthread_cond_init(&new_future->done, NULL);
+
+    if (res != 0) {
+        klispE_throw_simple_with_irritants(K, "Can't create future", 1, 
+                                           i2tv(res));
+        return KNIL;
+    }
+    return gc2future(new_future);
+}
+
+/* LOCK: GIL should be acquired exactly once */
+/* GC: future & obj should be rooted */
+void kfuture_complete(klisp_State *K, TValue future, TValue obj, bool errorp)
+{
+    UNUSED(K);
+    Future *f = tv2future(future);
+    klisp_assert(f->state == KFUTURE_PENDING);
+
+    f->value = obj;
+    f->state = errorp? KFUTURE_ERROR : KFUTURE_DONE;
+
+    int32_t ret = pthread_cond_broadcast(&f->done);
+    klisp_assert(ret == 0); /* shouldn't happen */
+    UNUSED(ret);
+}
+
+/* LOCK: GIL should be acquired exactly once */
+/* GC: future should be rooted */
+void kfuture_wait(klisp_State *K, TValue future)
+{
+    Future *f = tv2future(future);
+    while(f->state == KFUTURE_PENDING) {
+        /* this releases the GIL while blocked and takes it back 
+           before returning */
+        int32_t ret = pthread_cond_wait(&f->done, &G(K)->gil);
+        klisp_assert(ret == 0); /* shouldn't happen */
+        UNUSED(ret);
+    }
+}
+
+void klispFu_free(klisp_State *K, Future *f)
+{
+    UNUSED(pthread_cond_destroy(&f->done));
+    klispM_free(K, f);
+}
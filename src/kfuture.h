@@ -0,0 +1,28 @@
+/*
+** kfuture.h
+** Kernel Futures
+** See Copyright Notice in klisp.h
+*/
+
+#ifndef kfuture_h
+#define kfuture_h
+
+#include "kobject.h"
+#include "kstate.h"
+
+TValue kmake_future(klisp_State *K);
+void klispFu_free(klisp_State *K, Future *future);
+
+/* LOCK: these functions require that the calling code has 
+   acquired the GIL exactly once previous to the call */
+/* GC: future & obj should be rooted */
+void kfuture_complete(klisp_State *K, TValue future, TValue obj, bool errorp);
+/* waits (releasing the GIL) until future isn't pending */
+/* GC: future should be rooted */
+void kfuture_wait(klisp_State *K, TValue future);
+
+#define kfuture_state(f_) (tv2future(f_)->state)
+#define kfuture_value(f_) (tv2future(f_)->value)
+#define kfuture_pendingp(f_) (kfuture_state(f_) == KFUTURE_PENDING)
+
+#endif
@@ -18,6 +18,7 @@
 #include "kcontinuation.h"
 #include "kerror.h"
 #include "kbytevector.h"
+#include "kslice.h"
 
 #include "kghelpers.h"
 #include "kgbytevectors.h"
@@ -55,7 +56,7 @@ void bytevector_to_list(klisp_State *K)
     UNUSED(xparams);
     UNUSED(denv);
     
-    bind_1tp(K, ptree, "bytevector", ttisbytevector, bb);
+    bind_1tp(K, ptree, "bytevector", ttisbvview, bb);
 
     TValue res = bytevector_to_list_h(K, bb, NULL);
     kapply_cc(K, res);
@@ -118,9 +119,9 @@ void bytevector_length(klisp_State *K)
     klisp_assert(ttisenvironment(K->next_env));
     UNUSED(xparams);
     UNUSED(denv);
-    bind_1tp(K, ptree, "bytevector", ttisbytevector, bytevector);
+    bind_1tp(K, ptree, "bytevector", ttisbvview, bytevector);
 
-    TValue res = i2tv(kbytevector_size(bytevector));
+    TValue res = i2tv(kbvview_size(bytevector));
     kapply_cc(K, res);
 }
 
@@ -133,7 +134,7 @@ void bytevector_u8_ref(klisp_State *K)
     klisp_assert(ttisenvironment(K->next_env));
     UNUSED(xparams);
     UNUSED(denv);
-    bind_2tp(K, ptree, "bytevector", ttisbytevector, bytevector,
+    bind_2tp(K, ptree, "bytevector", ttisbvview, bytevector,
              "exact integer", keintegerp, tv_i);
 
     if (!ttisfixint(tv_i)) {
@@ -143,13 +144,13 @@ void bytevector_u8_ref(klisp_State *K)
     }
     int32_t i = ivalue(tv_i);
     
-    if (i < 0 || i >= kbytevector_size(bytevector)) {
+    if (i < 0 || i >= kbvview_size(bytevector)) {
         /* TODO show index */
         klispE_throw_simple(K, "index out of bounds");
         return;
     }
 
-    TValue res = i2tv(kbytevector_buf(bytevector)[i]);
+    TValue res = i2tv(kbvview_buf(bytevector)[i]);
     kapply_cc(K, res);
 }
 
@@ -196,15 +197,15 @@ void bytevector_copy(klisp_State *K)
     klisp_assert(ttisenvironment(K->next_env));
     UNUSED(xparams);
     UNUSED(denv);
-    bind_1tp(K, ptree, "bytevector", ttisbytevector, bytevector);
+    bind_1tp(K, ptree, "bytevector", ttisbvview, bytevector);
 
     TValue new_bytevector;
     /* the if isn't strictly necessary but it's clearer this way */
     if (tv_equal(bytevector, G(K)->empty_bytevector)) {
         new_bytevector = bytevector; 
     } else {
-        new_bytevector = kbytevector_new_bs(K, kbytevector_buf(bytevector),
-                                            kbytevector_size(bytevector));
+        new_bytevector = kbytevector_new_bs(K, kbvview_buf(bytevector),
+                                            kbvview_size(bytevector));
     }
     kapply_cc(K, new_bytevector);
 }
@@ -218,42 +219,48 @@ void bytevector_copyB(klisp_State *K)
     klisp_assert(ttisenvironment(K->next_env));
     UNUSED(xparams);
     UNUSED(denv);
-    bind_2tp(K, ptree, "bytevector", ttisbytevector, bytevector1, 
+    bind_2tp(K, ptree, "bytevector", ttisbvview, bytevector1, 
              "bytevector", ttisbytevector, bytevector2);
 
     if (kbytevector_immutablep(bytevector2)) {
         klispE_throw_simple(K, "immutable destination bytevector");
         return;
-    } else if (kbytevector_size(bytevector1) > kbytevector_size(bytevector2)) {
+    } else if (kbvview_size(bytevector1) > kbytevector_size(bytevector2)) {
         klispE_throw_simple(K, "destination bytevector is too small");
         return;
     }
 
     if (!tv_equal(bytevector1, bytevector2) && 
         !tv_equal(bytevector1, G(K)->empty_bytevector)) {
-        memcpy(kbytevector_buf(bytevector2),
-               kbytevector_buf(bytevector1),
-               kbytevector_size(bytevector1));
+        /* bytevector1 may be a slice of bytevector2 */
+        memmove(kbytevector_buf(bytevector2),
+                kbvview_buf(bytevector1),
+                kbvview_size(bytevector1));
     }
     kapply_cc(K, KINERT);
 }
 
 /* ?.? bytevector-copy-partial */
 /* TEMP: at least for now this always returns mutable bytevectors */
+/* ?.? bytevector-slice */
+/* this returns a slice sharing the bytes of bytevector instead */
 void bytevector_copy_partial(klisp_State *K)
 {
     TValue *xparams = K->next_xparams;
     TValue ptree = K->next_value;
     TValue denv = K->next_env;
     klisp_assert(ttisenvironment(K->next_env));
-    UNUSED(xparams);
+    /*
+    ** xparams[0]: slice?
+    */
+    bool slicep = bvalue(xparams[0]);
     UNUSED(denv);
-    bind_3tp(K, ptree, "bytevector", ttisbytevector, bytevector,
+    bind_3tp(K, ptree, "bytevector", ttisbvview, bytevector,
              "exact integer", keintegerp, tv_start,
              "exact integer", keintegerp, tv_end);
 
     if (!ttisfixint(tv_start) || ivalue(tv_start) < 0 ||
-        ivalue(tv_start) > kbytevector_size(bytevector)) {
+        ivalue(tv_start) > kbvview_size(bytevector)) {
         /* TODO show index */
         klispE_throw_simple(K, "start index out of bounds");
         return;
@@ -262,7 +269,7 @@ void bytevector_copy_partial(klisp_State *K)
     int32_t start = ivalue(tv_start);
 
     if (!ttisfixint(tv_end) || ivalue(tv_end) < 0 || 
-        ivalue(tv_end) > kbytevector_size(bytevector)) {
+        ivalue(tv_end) > kbvview_size(bytevector)) {
         klispE_throw_simple(K, "end index out of bounds");
         return;
     }
@@ -278,10 +285,13 @@ void bytevector_copy_partial(klisp_State *K)
     int32_t size = end - start;
     TValue new_bytevector;
     /* the if isn't strictly necessary but it's clearer this way */
-    if (size == 0) {
+    if (slicep) {
+        /* bytevector is rooted in ptree */
+        new_bytevector = kmake_slice(K, bytevector, start, size);
+    } else if (size == 0) {
         new_bytevector = G(K)->empty_bytevector;
     } else {
-        new_bytevector = kbytevector_new_bs(K, kbytevector_buf(bytevector) 
+        new_bytevector = kbytevector_new_bs(K, kbvview_buf(bytevector) 
                                             + start, size);
     }
     kapply_cc(K, new_bytevector);
@@ -296,7 +306,7 @@ void bytevector_copy_partialB(klisp_State *K)
     klisp_assert(ttisenvironment(K->next_env));
     UNUSED(xparams);
     UNUSED(denv);
-    bind_al3tp(K, ptree, "bytevector", ttisbytevector, bytevector1, 
+    bind_al3tp(K, ptree, "bytevector", ttisbvview, bytevector1, 
                "exact integer", keintegerp, tv_start,
                "exact integer", keintegerp, tv_end,
                rest);
@@ -307,7 +317,7 @@ void bytevector_copy_partialB(klisp_State *K)
              "exact integer", keintegerp, tv_start2);
 
     if (!ttisfixint(tv_start) || ivalue(tv_start) < 0 ||
-        ivalue(tv_start) > kbytevector_size(bytevector1)) {
+        ivalue(tv_start) > kbvview_size(bytevector1)) {
         /* TODO show index */
         klispE_throw_simple(K, "start index out of bounds");
         return;
@@ -316,7 +326,7 @@ void bytevector_copy_partialB(klisp_State *K)
     int32_t start = ivalue(tv_start);
 
     if (!ttisfixint(tv_end) || ivalue(tv_end) < 0 || 
-        ivalue(tv_end) > kbytevector_size(bytevector1)) {
+        ivalue(tv_end) > kbvview_size(bytevector1)) {
         klispE_throw_simple(K, "end index out of bounds");
         return;
     }
@@ -352,9 +362,10 @@ void bytevector_copy_partialB(klisp_State *K)
     }
 
     if (size > 0) {
-        memcpy(kbytevector_buf(bytevector2) + start2,
-               kbytevector_buf(bytevector1) + start,
-               size);
+        /* bytevector1 may be (a slice of) bytevector2 */
+        memmove(kbytevector_buf(bytevector2) + start2,
+                kbvview_buf(bytevector1) + start,
+                size);
     }
     kapply_cc(K, KINERT);
 }
@@ -393,15 +404,16 @@ void bytevector_to_immutable_bytevector(klisp_State *K)
     klisp_assert(ttisenvironment(K->next_env));
     UNUSED(xparams);
     UNUSED(denv);
-    bind_1tp(K, ptree, "bytevector", ttisbytevector, bytevector);
+    bind_1tp(K, ptree, "bytevector", ttisbvview, bytevector);
 
     TValue res_bytevector;
-    if (kbytevector_immutablep(bytevector)) {
+    if (ttisbytevector(bytevector) && 
+        kbytevector_immutablep(bytevector)) {
 /* this includes the empty bytevector */
         res_bytevector = bytevector;
     } else {
-        res_bytevector = kbytevector_new_bs_imm(K, kbytevector_buf(bytevector), 
-                                                kbytevector_size(bytevector));
+        res_bytevector = kbytevector_new_bs_imm(K, kbvview_buf(bytevector), 
+                                                kbvview_size(bytevector));
     }
     kapply_cc(K, res_bytevector);
 }
@@ -450,7 +462,12 @@ void kinit_bytevectors_ground_env(klisp_State *K)
 
     /* ??.1.?? bytevector-copy-partial */
     add_applicative(K, ground_env, "bytevector-copy-partial", 
-                    bytevector_copy_partial, 0);
+                    bytevector_copy_partial, 1, KFALSE);
+    /* ??.1.?? bytevector-slice?, bytevector-slice */
+    add_applicative(K, ground_env, "bytevector-slice?", ftypep, 2, symbol, 
+                    p2tv(kbytevector_slicep));
+    add_applicative(K, ground_env, "bytevector-slice", 
+                    bytevector_copy_partial, 1, KTRUE);
     /* ??.1.?? bytevector-copy-partial! */
     add_applicative(K, ground_env, "bytevector-copy-partial!", 
                     bytevector_copy_partialB, 0);
@@ -29,7 +29,12 @@
 #include "kvector.h"
 #include "kmutex.h"
 #include "kcondvar.h"
+#include "kstrbuilder.h"
+#include "kchannel.h"
+#include "kfuture.h"
+#include "kslice.h"
 #include "kerror.h"
+#include "ksystem.h"
 
 #define GCSTEPSIZE	1024u
 #define GCSWEEPMAX	40
@@ -125,6 +130,11 @@ static void reallymarkobject (global_State *g, GCObject *o)
     case K_TTHREAD:
     case K_TMUTEX:
     case K_TCONDVAR:
+    case K_TSTRBUILDER:
+    case K_TSLICE:
+    case K_TGVECTOR:
+    case K_TCHANNEL:
+    case K_TFUTURE:
         o->gch.gclist = g->gray;
         g->gray = o;
         break;
@@ -182,11 +192,24 @@ size_t klispC_separateudata (lua_State *L, int all) {
 
 #endif
 
+static int32_t iscleared (TValue o, int iskey);
+
+/* long immutable strings aren't interned but are eq? iff they have the
+   same chars (see kstring_imm_eqp), so a different string may still
+   find their entry: as keys, they are always kept (like lua strings) */
+static bool isvaluekey (TValue o) {
+    return ttisstring(o) && kstring_immutablep(o) && 
+        kstring_size(o) > KMAXINTERNSTRLEN;
+}
+
 static int32_t traversetable (global_State *g, Table *h) {
     int32_t i;
     TValue tv = gc2table(h);
     int32_t weakkey = ktable_has_weak_keys(tv)? 1 : 0;
     int32_t weakvalue = ktable_has_weak_values(tv)? 1 : 0;
+    /* in ephemeron tables, values are only marked if the key is already
+       marked, the rest are retried in atomic (see convergeephemerons) */
+    int32_t ephemeron = ktable_is_ephemeron(tv)? 1 : 0;
 
     if (weakkey || weakvalue) {  /* is really weak? */
         h->gct &= ~(KEYWEAK | VALUEWEAK);  /* clear bits */
@@ -210,13 +233,31 @@ static int32_t traversetable (global_State *g, Table *h) {
             removeentry(n);  /* remove empty entries */
         else {
             klisp_assert(!ttisfree(gkey(n)->this));
-            if (!weakkey) markvalue(g, gkey(n)->this);
-            if (!weakvalue) markvalue(g, gval(n));
+            if (!weakkey || isvaluekey(gkey(n)->this)) 
+                markvalue(g, gkey(n)->this);
+            if (!weakvalue && (!ephemeron || !iscleared(key2tval(n), 1)))
+                markvalue(g, gval(n));
         }
     }
     return weakkey || weakvalue;
 }
 
+/* mark the values of entries whose keys are marked, returns true if
+   any value was marked */
+static bool traverseephemeron (global_State *g, Table *h) {
+    bool marked = false;
+    int32_t i = sizenode(h);
+    while (i--) {
+        Node *n = gnode(h, i);
+        if (!ttisfree(gval(n)) && !iscleared(key2tval(n), 1) && 
+            iscleared(gval(n), 0)) {
+            markvalue(g, gval(n));
+            marked = true;
+        }
+    }
+    return marked;
+}
+
 #if 0
 /*
 ** All marks are conditional because a GC may happen while the
@@ -373,6 +414,13 @@ static int32_t propagatemark (global_State *g) {
         markvalue(g, K->next_env);
         markvalue(g, K->next_si);
         /* NOTE: next_x_params is protected by next_obj */
+        markvalue(g, K->kd_bindings);
+        markvalue(g, K->kd_base_bindings);
+        /* the cache may still have keys & bindings from a previous 
+           kd_bindings */
+        markvalue(g, K->kd_cache_bindings);
+        markvaluearray(g, K->kd_cache_keys, KDCACHESIZE);
+        markvaluearray(g, K->kd_cache_binds, KDCACHESIZE);
 
         markvalue(g, K->shared_dict);
         markvalue(g, K->curr_port);
@@ -401,6 +449,36 @@ static int32_t propagatemark (global_State *g) {
         markvalue(g, c->mutex);
         return sizeof(Condvar);
     }
+    case K_TSTRBUILDER: {
+        StrBuilder *b = cast(StrBuilder *, o);
+        /* the buffer has no references */
+        return sizeof(StrBuilder) + 
+            (b->buf == NULL? 0 : sizeof(String) + b->capacity + 1);
+    }
+    case K_TSLICE: {
+        Slice *s = cast(Slice *, o);
+        markvalue(g, s->parent);
+        return sizeof(Slice);
+    }
+    case K_TGVECTOR: {
+        GVector *v = cast(GVector *, o);
+        if (v->buf == NULL)
+            return sizeof(GVector);
+        /* only the elements in use are marked */
+        markvaluearray(g, v->buf->array, v->buf->sizearray);
+        return sizeof(GVector) + sizeof(Vector) + 
+            v->capacity * sizeof(TValue);
+    }
+    case K_TCHANNEL: {
+        Channel *c = cast(Channel *, o);
+        markvalue(g, c->buf);
+        return sizeof(Channel);
+    }
+    case K_TFUTURE: {
+        Future *f = cast(Future *, o);
+        markvalue(g, f->value);
+        return sizeof(Future);
+    }
     default: 
         fprintf(stderr, "Unknown GCObject type (in GC propagate): %d\n", 
                 type);
@@ -443,6 +521,25 @@ static int32_t iscleared (TValue o, int iskey) {
 /*
 ** clear collected entries from weaktables
 */
+/*
+** Keep marking values of ephemeron tables until no more keys become
+** reachable.  All weak tables are in the weak list at this point.
+*/
+static void convergeephemerons (global_State *g) {
+    bool changed;
+    do {
+        changed = false;
+        for (GCObject *l = g->weak; l != NULL; l = ((Table *) l)->gclist) {
+            Table *h = (Table *) l;
+            if (ktable_is_ephemeron(gc2table(h)) && 
+                traverseephemeron(g, h)) {
+                propagateall(g);
+                changed = true;
+            }
+        }
+    } while (changed);
+}
+
 static void cleartable (GCObject *l) {
     while (l) {
         Table *h = (Table *) (l);
@@ -499,8 +596,8 @@ static void freeobj (klisp_State *K, GCObject *o) {
         klispM_free(K, (Keyword *)o);
         break;
     case K_TSTRING:
-        /* immutable strings are in the string/symbol table */
-        if (kstring_immutablep(gc2str(o)))
+        /* short immutable strings are in the string/symbol table */
+        if (kstring_internedp(gc2str(o)))
             G(K)->strt.nuse--;
         klispM_freemem(K, o, sizeof(String)+o->str.size+1);
         break;
@@ -572,6 +669,21 @@ static void freeobj (klisp_State *K, GCObject *o) {
     case K_TCONDVAR:
         klispV_free(K, (Condvar *) o);
         break;
+    case K_TSTRBUILDER:
+        klispSB_free(K, (StrBuilder *) o);
+        break;
+    case K_TSLICE:
+        klispM_free(K, (Slice *) o);
+        break;
+    case K_TGVECTOR:
+        klispGV_free(K, (GVector *) o);
+        break;
+    case K_TCHANNEL:
+        klispCh_free(K, (Channel *) o);
+        break;
+    case K_TFUTURE:
+        klispFu_free(K, (Future *) o);
+        break;
     default:
         /* shouldn't happen */
         fprintf(stderr, "Unknown GCObject type (in GC free): %d\n", 
@@ -668,6 +780,7 @@ void klispC_freeall (klisp_State *K) {
     g->currentwhite = WHITEBITS | bitmask(SFIXEDBIT);
     sweepwholelist(K, &g->rootgc);
     /* free all keyword/symbol/string/bytevectors lists */
+    klispS_finish_resize(K);
     for (int32_t i = 0; i < g->strt.size; i++)  
         sweepwholelist(K, &g->strt.hash[i]);
 }
@@ -684,6 +797,11 @@ static void markroot (klisp_State *K) {
     markvalue(g, g->name_table);
     markvalue(g, g->cont_name_table);
     markvalue(g, g->thread_table);
+    markvalue(g, g->pool_queue);
+    markvalue(g, g->pool_threads);
+    markvalue(g, g->prof_table);
+    markvalue(g, g->calls_table);
+    markvalue(g, g->calls_last);
 
     markvalue(g, g->eval_op);
     markvalue(g, g->list_app);
@@ -731,6 +849,9 @@ static void atomic (klisp_State *K) {
     g->grayagain = NULL;
     propagateall(g);
 
+    /* mark values of ephemerons with reachable keys */
+    convergeephemerons(g);
+
     udsize = 0; /* to init var 'till we add user data */
 #if 0 /* keep around */
     udsize = klispC_separateudata(L, 0);  /* separate userdata to be finalized */
@@ -765,6 +886,8 @@ static int32_t singlestep (klisp_State *K) {
     }
     case GCSsweepstring: {
         uint32_t old = g->totalbytes;
+        if (g->sweepstrgc == 0) /* finish moving buckets before sweeping */
+            klispS_finish_resize(K);
         sweepwholelist(K, &g->strt.hash[g->sweepstrgc++]);
         if (g->sweepstrgc >= g->strt.size)  /* nothing more to sweep? */
             g->gcstate = GCSsweep;  /* end sweep-string phase */
@@ -836,6 +959,7 @@ void klispC_step (klisp_State *K) {
 
 void klispC_fullgc (klisp_State *K) {
     global_State *g = G(K);
+    uint64_t start = ksystem_current_usecs(K);
     if (g->gcstate <= GCSpropagate) {
         /* reset sweep marks to sweep all elements (returning them to white) */
         g->sweepstrgc = 0;
@@ -857,6 +981,149 @@ void klispC_fullgc (klisp_State *K) {
         singlestep(K);
     }
     setthreshold(g);
+
+    uint64_t pause = ksystem_current_usecs(K) - start;
+    g->gccount++;
+    g->gctime += pause;
+    if (pause > g->gcmaxpause)
+        g->gcmaxpause = pause;
+}
+
+/*
+** Heap statistics
+*/
+static const char *typenames[KGC_NTYPES] = {
+    [K_TBIGINT] = "bigint",
+    [K_TBIGRAT] = "bigrat",
+    [K_TPAIR] = "pair",
+    [K_TSTRING] = "string",
+    [K_TSYMBOL] = "symbol",
+    [K_TENVIRONMENT] = "environment",
+    [K_TCONTINUATION] = "continuation",
+    [K_TOPERATIVE] = "operative",
+    [K_TAPPLICATIVE] = "applicative",
+    [K_TENCAPSULATION] = "encapsulation",
+    [K_TPROMISE] = "promise",
+    [K_TTABLE] = "hash-table",
+    [K_TERROR] = "error",
+    [K_TBYTEVECTOR] = "bytevector",
+    [K_TFPORT] = "file-port",
+    [K_TMPORT] = "memory-port",
+    [K_TVECTOR] = "vector",
+    [K_TKEYWORD] = "keyword",
+    [K_TLIBRARY] = "library",
+    [K_TTHREAD] = "thread",
+    [K_TMUTEX] = "mutex",
+    [K_TCONDVAR] = "condition-variable",
+    [K_TSTRBUILDER] = "string-builder",
+    [K_TSLICE] = "slice",
+    [K_TGVECTOR] = "growable-vector",
+    [K_TCHANNEL] = "channel",
+    [K_TFUTURE] = "future",
+};
+
+const char *klispC_typename (int32_t tt) {
+    const char *name = (tt >= 0 && tt < KGC_NTYPES)? typenames[tt] : NULL;
+    return name == NULL? "unknown" : name;
+}
+
+static uint32_t bigintsize (Bigint *b) {
+    /* small bigints use the single field for the digits */
+    if ((void *) b->digits == (void *) &(b->single))
+        return 0;
+    return b->alloc * sizeof(uint32_t);
+}
+
+/* bytes allocated for an object (this doesn't include the memory
+   outside the klisp allocator, like FILEs in ports) */
+static uint32_t objsize (GCObject *o) {
+    switch (o->gch.tt) {
+    case K_TBIGINT:
+        return sizeof(Bigint) + bigintsize((Bigint *) o);
+    case K_TBIGRAT: {
+        Bigrat *r = (Bigrat *) o;
+        return sizeof(Bigrat) + bigintsize(&r->num) + bigintsize(&r->den);
+    }
+    case K_TPAIR: return sizeof(Pair);
+    case K_TSYMBOL: return sizeof(Symbol);
+    case K_TKEYWORD: return sizeof(Keyword);
+    case K_TSTRING: return sizeof(String) + o->str.size + 1;
+    case K_TENVIRONMENT: return sizeof(Environment);
+    case K_TCONTINUATION:
+        return sizeof(Continuation) + o->cont.extra_size * sizeof(TValue);
+    case K_TOPERATIVE:
+        return sizeof(Operative) + o->op.extra_size * sizeof(TValue);
+    case K_TAPPLICATIVE: return sizeof(Applicative);
+    case K_TENCAPSULATION: return sizeof(Encapsulation);
+    case K_TPROMISE: return sizeof(Promise);
+    case K_TTABLE: {
+        Table *h = (Table *) o;
+        return sizeof(Table) + sizeof(TValue) * h->sizearray +
+            sizeof(Node) * sizenode(h);
+    }
+    case K_TERROR: return sizeof(Error);
+    case K_TBYTEVECTOR: return sizeof(Bytevector) + o->bytevector.size;
+    case K_TFPORT: return sizeof(FPort);
+    case K_TMPORT: return sizeof(MPort);
+    case K_TVECTOR: 
+        return sizeof(Vector) + sizeof(TValue) * o->vector.sizearray;
+    case K_TLIBRARY: return sizeof(Library);
+    case K_TTHREAD: return sizeof(klisp_State);
+    case K_TMUTEX: return sizeof(Mutex);
+    case K_TCONDVAR: return sizeof(Condvar);
+    case K_TSTRBUILDER: 
+        return sizeof(StrBuilder) + (o->strb.buf == NULL? 0 :
+                                     sizeof(String) + o->strb.capacity + 1);
+    case K_TSLICE: return sizeof(Slice);
+    case K_TGVECTOR: 
+        return sizeof(GVector) + (o->gvector.buf == NULL? 0 :
+                                  sizeof(Vector) + 
+                                  sizeof(TValue) * o->gvector.capacity);
+    case K_TCHANNEL: return sizeof(Channel);
+    case K_TFUTURE: return sizeof(Future);
+    default: return 0;
+    }
+}
+
+static void histogramlist (GCObject *o, kgc_histogram *h) {
+    for (; o != NULL; o = o->gch.next) {
+        int32_t tt = o->gch.tt;
+        klisp_assert(tt >= 0 && tt < KGC_NTYPES);
+        h->count[tt]++;
+        h->bytes[tt] += objsize(o);
+    }
+}
+
+/* LOCK: GIL should be acquired */
+void klispC_histogram (klisp_State *K, kgc_histogram *h) {
+    global_State *g = G(K);
+    memset(h, 0, sizeof(kgc_histogram));
+    histogramlist(g->rootgc, h);
+    /* immutable strings, symbols, keywords & bytevectors */
+    for (int32_t i = 0; i < g->strt.size; i++)
+        histogramlist(g->strt.hash[i], h);
+    if (g->strt.oldhash != NULL) {
+        for (int32_t i = 0; i < g->strt.oldsize; i++)
+            histogramlist(g->strt.oldhash[i], h);
+    }
+}
+
+/* LOCK: GIL should be acquired */
+void klispC_dump_histogram (klisp_State *K, FILE *file) {
+    kgc_histogram h;
+    uint32_t count = 0;
+    uint64_t bytes = 0;
+    klispC_histogram(K, &h);
+    fprintf(file, "%-20s %10s %12s\n", "type", "count", "bytes");
+    for (int32_t tt = 0; tt < KGC_NTYPES; tt++) {
+        if (h.count[tt] == 0) continue;
+        fprintf(file, "%-20s %10u %12llu\n", klispC_typename(tt), 
+                h.count[tt], (unsigned long long) h.bytes[tt]);
+        count += h.count[tt];
+        bytes += h.bytes[tt];
+    }
+    fprintf(file, "%-20s %10u %12llu\n", "total", count, 
+            (unsigned long long) bytes);
 }
 
 /* TODO: make all code using mutation to call these,
@@ -111,4 +111,20 @@ void klispC_link (klisp_State *K, GCObject *o, uint8_t tt, uint8_t flags);
 void klispC_barrierf (klisp_State *K, GCObject *o, GCObject *v);
 void klispC_barrierback (klisp_State *K, Table *t);
 
+/*
+** Heap statistics
+** The live objects are counted walking rootgc & the string table,
+** so to count only reachable objects a collection should be done first.
+*/
+#define KGC_NTYPES (K_TDEADKEY+1)
+
+typedef struct {
+    uint32_t count[KGC_NTYPES]; /* number of objects of each type */
+    uint64_t bytes[KGC_NTYPES]; /* bytes used by the objects of each type */
+} kgc_histogram;
+
+const char *klispC_typename (int32_t tt);
+void klispC_histogram (klisp_State *K, kgc_histogram *h);
+void klispC_dump_histogram (klisp_State *K, FILE *file);
+
 #endif
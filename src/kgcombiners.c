@@ -30,6 +30,7 @@ void do_map(klisp_State *K);
 void do_map_ret(klisp_State *K);
 void do_map_encycle(klisp_State *K);
 void do_map_cycle(klisp_State *K);
+void do_map_stream(klisp_State *K);
 
 void do_array_map_ret(klisp_State *K);
 
@@ -61,7 +62,8 @@ void Svau(klisp_State *K)
 
     krooted_tvs_push(K, vbody);
     
-    TValue new_op = kmake_operative(K, do_vau, 4, vptree, vpenv, vbody, denv);
+    TValue new_op = kmake_operative(K, do_vau, 5, vptree, vpenv, vbody, denv,
+                                    b2tv(ptree_flatp(vptree)));
 
 #if KTRACK_SI
     /* save as source code info the info from the expression whose evaluation
@@ -93,11 +95,13 @@ void do_vau(klisp_State *K)
     ** xparams[1]: penv
     ** xparams[2]: body
     ** xparams[3]: senv
+    ** xparams[4]: flat ptree? (see ptree_flatp)
     */
     TValue op_ptree = xparams[0];
     TValue penv = xparams[1];
     TValue body = xparams[2];
     TValue senv = xparams[3];
+    bool flatp = bvalue(xparams[4]);
 
     /* bindings in an operative are in a child of the static env */
     TValue env = kmake_environment(K, senv);
@@ -105,9 +109,11 @@ void do_vau(klisp_State *K)
     /* protect env */
     krooted_tvs_push(K, env); 
 
-    match(K, env, op_ptree, ptree);
+    /* env is new & check_copy_ptree already checked that all symbols
+       are different, so there's no need to look for previous bindings */
+    match_new(K, env, op_ptree, flatp, ptree);
     if (!ttisignore(penv))
-        kadd_binding(K, env, penv, denv);
+        kadd_new_binding(K, env, penv, denv);
 
     /* keep env in stack in case a cont has to be constructed */
     
@@ -193,8 +199,8 @@ void Slambda(klisp_State *K)
 
     krooted_tvs_push(K, vbody); 
 
-    TValue new_app = kmake_applicative(K, do_vau, 4, vptree, KIGNORE, vbody, 
-                                       denv);
+    TValue new_app = kmake_applicative(K, do_vau, 5, vptree, KIGNORE, vbody, 
+                                       denv, b2tv(ptree_flatp(vptree)));
 #if KTRACK_SI
     /* save as source code info the info from the expression whose evaluation
        got us here, both for the applicative and the underlying combiner */
@@ -379,6 +385,126 @@ void do_map_cycle(klisp_State *K)
     kapply_cc(K, KINERT);
 }
 
+/* Reverse (in place) the list of results of a streaming map and encycle
+   it if necessary, like reverse_copy_and_encycle. Only used when all the
+   pairs in ls were made by a single run of do_map_stream that didn't
+   let its frame escape, so that nothing else can reference them */
+static TValue reverse_and_encycle(TValue ls, int32_t pairs, int32_t cpairs)
+{
+    if (pairs == 0)
+        return KNIL;
+
+    /* the first pair will be the last one of the result */
+    TValue last = ls;
+    TValue res = KNIL;
+    TValue cycle = KNIL;
+    for (int32_t i = 0; i < pairs; ++i) {
+        TValue next = kcdr(ls);
+        kset_cdr(ls, res);
+        res = ls;
+        /* the results of the cycle come first in the reversed list */
+        if (i == cpairs - 1)
+            cycle = ls;
+        ls = next;
+    }
+    if (cpairs > 0)
+        kset_cdr(last, cycle);
+    return res;
+}
+
+/* For acyclic lists of lists: walk the lists in lockstep (see 
+   map_for_each_next), accumulating the results in reverse order */
+void do_map_stream(klisp_State *K)
+{
+    TValue *xparams = K->next_xparams;
+    TValue obj = K->next_value;
+    klisp_assert(ttisnil(K->next_env));
+    /*
+    ** xparams[0]: app
+    ** xparams[1]: remaining lists (see map_for_each_next)
+    ** xparams[2]: number of lists
+    ** xparams[3]: reversed results
+    ** xparams[4]: remaining pairs
+    ** xparams[5]: res-pairs
+    ** xparams[6]: res-cpairs
+    ** xparams[7]: denv
+    ** xparams[8]: dummyp
+    */
+    TValue app = xparams[0];
+    TValue tails = xparams[1];
+    int32_t n = ivalue(xparams[2]);
+    TValue acc = xparams[3];
+    int32_t rem_pairs = ivalue(xparams[4]);
+    int32_t res_pairs = ivalue(xparams[5]);
+    int32_t res_cpairs = ivalue(xparams[6]);
+    TValue denv = xparams[7];
+    bool dummyp = bvalue(xparams[8]);
+    /* if this is the first element, all the results will be consed 
+       here and they may be reversed in place at the end */
+    bool freshp = ttisnil(acc);
+
+    /* the results are consed in a new list each time (instead of
+       appending to the last pair) so that continuations captured from 
+       within the dynamic extent of map can be safely reentered */
+    if (!dummyp)
+        acc = kcons(K, obj, acc);
+
+    krooted_tvs_push(K, acc);
+    if (rem_pairs == 0) {
+        /* reverse the results and encycle if necessary */
+        TValue res = reverse_copy_and_encycle(K, acc, res_pairs, res_cpairs);
+        krooted_tvs_pop(K);
+        kapply_cc(K, res);
+    }
+
+    krooted_vars_push(K, &tails);
+    TValue ptree = map_for_each_next(K, &tails, n);
+    krooted_tvs_push(K, ptree);
+    TValue frame = 
+        kmake_continuation(K, kget_cc(K), do_map_stream, 9, app, tails,
+                           i2tv(n), acc, i2tv(rem_pairs-1), 
+                           i2tv(res_pairs), i2tv(res_cpairs), denv, 
+                           KFALSE);
+    krooted_tvs_pop(K);
+    krooted_tvs_pop(K);
+    krooted_vars_pop(K);
+
+    if (!ttisoperative(kunwrap(app))) {
+        kset_cc(K, frame);
+        ktail_apply_ptree(K, app, ptree, denv);
+    }
+
+    /* app wraps an operative: call it directly, and while it returns
+       right away (without capturing the frame) reuse the frame for the 
+       next element instead of making a new continuation each time. 
+       The operand list is still new each time because the operative 
+       may keep it (e.g. list) */
+    TValue *fx = tv2cont(frame)->extra;
+    TValue value;
+    while(kcall_direct(K, frame, app, ptree, denv, &value)) {
+        /* frame is K->next_obj, so fx is reachable from K */
+        acc = kcons(K, value, fx[3]);
+        fx[3] = acc;
+        rem_pairs = ivalue(fx[4]);
+        if (rem_pairs == 0) {
+            /* the current continuation is already the parent of frame */
+            TValue res = freshp? 
+                reverse_and_encycle(acc, res_pairs, res_cpairs) :
+                reverse_copy_and_encycle(K, acc, res_pairs, res_cpairs);
+            kapply_cc(K, res);
+        }
+        tails = fx[1];
+        krooted_vars_push(K, &tails);
+        ptree = map_for_each_next(K, &tails, n);
+        krooted_vars_pop(K);
+        fx[1] = tails;
+        fx[4] = i2tv(rem_pairs-1);
+    }
+    /* the operative didn't return directly (e.g. it's a compound 
+       operative), the main loop will eventually return to frame, which 
+       may now be captured and so it is never mutated again */
+}
+
 /* 5.9.1 map */
 void map(klisp_State *K)
 {
@@ -405,7 +531,29 @@ void map(klisp_State *K)
     app_pairs = app_apairs + app_cpairs;
     res_pairs = res_apairs + res_cpairs;
     UNUSED(app_pairs);
-    UNUSED(res_pairs);
+
+    if (app_cpairs == 0) {
+        /* There is no need to transpose the lists, they can be walked 
+           in lockstep. The list of lists is copied to avoid problems
+           with mutation, but the lists themselves aren't: they are
+           checked on each step, so a mutation of the cars not yet
+           reached is seen by app, and shortening a list signals an
+           error (see map_for_each_next) */
+        TValue tails = app_apairs == 1? kcar(lss) : 
+            check_copy_list(K, lss, false, NULL, NULL);
+        krooted_tvs_push(K, tails);
+        /* signal dummyp = true to avoid creating a pair for
+           the inert value passed to the first continuation */
+        TValue new_cont = 
+            kmake_continuation(K, kget_cc(K), do_map_stream, 9, app, tails,
+                               i2tv(app_apairs), KNIL, i2tv(res_pairs), 
+                               i2tv(res_pairs), i2tv(res_cpairs), denv, 
+                               KTRUE);
+        krooted_tvs_pop(K);
+        kset_cc(K, new_cont);
+        /* this will be a nop, and will continue with do_map_stream */
+        kapply_cc(K, KINERT);
+    }
 
     /* create the list of parameters to app */
     lss = map_for_each_transpose(K, lss, app_apairs, app_cpairs, 
@@ -631,6 +779,7 @@ void kinit_combiners_cont_names(klisp_State *K)
     add_cont_name(K, t, do_map_encycle, "map-encycle!");
     add_cont_name(K, t, do_map_ret, "map-ret");
     add_cont_name(K, t, do_map_cycle, "map-cyclic-part");
+    add_cont_name(K, t, do_map_stream, "map");
 
     add_cont_name(K, t, do_array_map_ret, "array-map-ret");
 }
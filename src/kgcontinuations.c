@@ -242,6 +242,138 @@ void Slet_cc(klisp_State *K)
 /* 7.3.3 guard-dynamic-extent */
 /* in kghelpers */
 
+/*
+** Escape continuations
+**
+** These are a cheaper alternative to call/cc & $let/cc for the common
+** case of early exits. An escape is an applicative that can only be
+** used within the dynamic extent of the call that created it. The
+** extent is delimited by a marker continuation; calling the escape
+** checks that the marker is an ancestor of the current continuation
+** and simply returns to it, without creating interception lists or
+** longjmp-ing out of the current call. If there are exit guards
+** between the current continuation and the marker the general
+** mechanism in kcall_cont() is used instead.
+*/
+
+/* marker continuation, just passes the value */
+static void do_ec_exit(klisp_State *K)
+{
+    TValue *xparams = K->next_xparams;
+    TValue obj = K->next_value;
+    klisp_assert(ttisnil(K->next_env));
+    UNUSED(xparams);
+    kapply_cc(K, obj);
+}
+
+/* underlying operative of escape applicatives */
+static void ec_app(klisp_State *K)
+{
+    TValue *xparams = K->next_xparams;
+    TValue ptree = K->next_value;
+    TValue denv = K->next_env;
+    klisp_assert(ttisenvironment(K->next_env));
+    UNUSED(denv);
+    /*
+    ** xparams[0]: marker continuation
+    */
+    bind_1p(K, ptree, obj);
+    TValue marker = xparams[0];
+
+    /* the marker should be an ancestor of the current continuation,
+       otherwise the escape is outside of its dynamic extent */
+    bool guardedp = false;
+    bool dynp = false;
+    TValue cont = kget_cc(K);
+    while(!ttisnil(cont) && !tv_equal(cont, marker)) {
+        /* only inner conts have exit guards */
+        guardedp |= kis_inner_cont(cont);
+        dynp |= kis_dyn_cont(cont);
+        cont = tv2cont(cont)->parent;
+    }
+
+    if (ttisnil(cont)) {
+        klispE_throw_simple(K, "escape called outside of its dynamic "
+                            "extent");
+        return;
+    } else if (guardedp) {
+        /* guards and dynamic variables are handled in kcall_cont() */
+        kcall_cont(K, marker, obj);
+    } else {
+        if (dynp)
+            klispT_restore_kd_bindings(K, marker);
+        kset_cc(K, marker);
+        kapply_cc(K, obj);
+    }
+}
+
+/* Helper for call/ec & $let/ec, returns the escape and leaves the
+   marker as the current continuation */
+static TValue make_escape(klisp_State *K)
+{
+    TValue marker = kmake_continuation(K, kget_cc(K), do_ec_exit, 0);
+    kset_cc(K, marker); /* this implicitly roots marker */
+    return kmake_applicative(K, ec_app, 1, marker);
+}
+
+/* call/ec */
+void call_ec(klisp_State *K)
+{
+    TValue *xparams = K->next_xparams;
+    TValue ptree = K->next_value;
+    TValue denv = K->next_env;
+    klisp_assert(ttisenvironment(K->next_env));
+    UNUSED(xparams);
+    bind_1tp(K, ptree, "combiner", ttiscombiner, comb);
+
+    TValue escape = make_escape(K);
+    krooted_tvs_push(K, escape);
+    TValue expr = klist(K, 2, comb, escape);
+    krooted_tvs_pop(K);
+    ktail_eval(K, expr, denv);
+}
+
+/* $let/ec */
+void Slet_ec(klisp_State *K)
+{
+    TValue *xparams = K->next_xparams;
+    TValue ptree = K->next_value;
+    TValue denv = K->next_env;
+    klisp_assert(ttisenvironment(K->next_env));
+    UNUSED(xparams);
+    bind_al1tp(K, ptree, "symbol", ttissymbol, sym, objs);
+
+    if (ttisnil(objs)) {
+        /* we don't even bother creating the escape */
+        kapply_cc(K, KINERT);
+    } else {
+        /* the list of instructions is copied to avoid mutation */
+        TValue ls = check_copy_list(K, objs, false, NULL, NULL);
+        krooted_tvs_push(K, ls);
+
+        TValue new_env = kmake_environment(K, denv);
+        krooted_tvs_push(K, new_env);
+        TValue escape = make_escape(K);
+        krooted_tvs_push(K, escape);
+        kadd_binding(K, new_env, sym, escape);
+        krooted_tvs_pop(K);
+
+        /* this is needed because seq continuation doesn't check for 
+           nil sequence */
+        TValue tail = kcdr(ls);
+        if (ttispair(tail)) {
+            TValue new_cont = kmake_continuation(K, kget_cc(K),
+                                                 do_seq, 2, tail, new_env);
+            kset_cc(K, new_cont);
+        } 
+
+        krooted_tvs_pop(K); 
+        krooted_tvs_pop(K);
+
+        ktail_eval(K, kcar(ls), new_env);
+    }
+}
+
 /* 7.3.4 exit */    
 /* Unlike in the report, in klisp this takes an optional argument
    to be passed to the root continuation (defaults to #inert) */
@@ -298,6 +430,10 @@ void kinit_continuations_ground_env(klisp_State *K)
     /* 7.3.3 guard-dynamic-extent */
     add_applicative(K, ground_env, "guard-dynamic-extent", 
                     guard_dynamic_extent, 0);
+    /* call/ec */
+    add_applicative(K, ground_env, "call/ec", call_ec, 0);
+    /* $let/ec */
+    add_operative(K, ground_env, "$let/ec", Slet_ec, 0);
     /* 7.3.4 exit */    
     add_applicative(K, ground_env, "exit", kgexit, 
                     0);
@@ -311,6 +447,7 @@ void kinit_continuations_cont_names(klisp_State *K)
     
     add_cont_name(K, t, do_extended_cont, "extended-cont");
     add_cont_name(K, t, do_root_exit, "exit");
+    add_cont_name(K, t, do_ec_exit, "escape-exit");
     /* this is defined in kcontinuation.c */
     add_cont_name(K, t, do_interception, "do-interception");
 }
@@ -23,6 +23,7 @@
 void do_select_clause(klisp_State *K);
 void do_cond(klisp_State *K);
 void do_for_each(klisp_State *K);
+void do_for_each_stream(klisp_State *K);
 void do_Swhen_Sunless(klisp_State *K);
 
 /* 4.5.1 inert? */
@@ -332,6 +333,69 @@ void do_for_each(klisp_State *K)
     }
 }
 
+/* Helper continuation for for-each with acyclic lists of lists: 
+   walk the lists in lockstep (see map_for_each_next) */
+void do_for_each_stream(klisp_State *K)
+{
+    TValue *xparams = K->next_xparams;
+    TValue obj = K->next_value;
+    klisp_assert(ttisnil(K->next_env));
+    /*
+    ** xparams[0]: app
+    ** xparams[1]: remaining lists (see map_for_each_next)
+    ** xparams[2]: number of lists
+    ** xparams[3]: remaining pairs
+    ** xparams[4]: denv
+    */
+    TValue app = xparams[0];
+    TValue tails = xparams[1];
+    int32_t n = ivalue(xparams[2]);
+    int32_t rem_pairs = ivalue(xparams[3]);
+    TValue denv = xparams[4];
+
+    /* the resulting value is just ignored */
+    UNUSED(obj);
+
+    if (rem_pairs == 0) {
+        /* return inert as the final result to for-each */
+        kapply_cc(K, KINERT);
+    }
+
+    krooted_vars_push(K, &tails);
+    TValue ptree = map_for_each_next(K, &tails, n);
+    krooted_tvs_push(K, ptree);
+    TValue frame = 
+        kmake_continuation(K, kget_cc(K), do_for_each_stream, 5, 
+                           app, tails, i2tv(n), i2tv(rem_pairs-1), denv);
+    krooted_tvs_pop(K);
+    krooted_vars_pop(K);
+
+    if (!ttisoperative(kunwrap(app))) {
+        kset_cc(K, frame);
+        ktail_apply_ptree(K, app, ptree, denv);
+    }
+
+    /* app wraps an operative: reuse the frame while the calls return
+       directly (see do_map_stream) */
+    TValue *fx = tv2cont(frame)->extra;
+    TValue value;
+    while(kcall_direct(K, frame, app, ptree, denv, &value)) {
+        rem_pairs = ivalue(fx[3]);
+        if (rem_pairs == 0) {
+            /* the current continuation is already the parent of frame */
+            kapply_cc(K, KINERT);
+        }
+        tails = fx[1];
+        krooted_vars_push(K, &tails);
+        ptree = map_for_each_next(K, &tails, n);
+        krooted_vars_pop(K);
+        fx[1] = tails;
+        fx[3] = i2tv(rem_pairs-1);
+    }
+    /* the main loop will eventually return to frame, which may now be
+       captured and so it is never mutated again */
+}
+
 /* 6.9.1 for-each */
 void for_each(klisp_State *K)
 {
@@ -359,6 +423,24 @@ void for_each(klisp_State *K)
     UNUSED(app_pairs);
     res_pairs = res_apairs + res_cpairs;
 
+    if (app_cpairs == 0) {
+        /* There is no need to transpose the lists, they can be walked 
+           in lockstep (see map) */
+        TValue tails = app_apairs == 1? kcar(lss) : 
+            check_copy_list(K, lss, false, NULL, NULL);
+        krooted_tvs_push(K, tails);
+        /* the cycle is just ignored, this will also return #inert once 
+           done. */
+        TValue new_cont = 
+            kmake_continuation(K, kget_cc(K), do_for_each_stream, 5, app, 
+                               tails, i2tv(app_apairs), i2tv(res_pairs), 
+                               denv);
+        krooted_tvs_pop(K);
+        kset_cc(K, new_cont);
+        /* this will be a nop */
+        kapply_cc(K, KINERT);
+    }
+
     /* create the list of parameters to app */
     lss = map_for_each_transpose(K, lss, app_apairs, app_cpairs, 
                                  res_apairs, res_cpairs);
@@ -590,4 +672,5 @@ void kinit_control_cont_names(klisp_State *K)
 
     add_cont_name(K, t, do_cond, "eval-cond-list");
     add_cont_name(K, t, do_for_each, "for-each");
+    add_cont_name(K, t, do_for_each_stream, "for-each");
 }
@@ -9,6 +9,9 @@
 
 #include "kstate.h"
 
+/* 4.2.1 eq? (used in kgpairs_lists for fast paths) */
+void eqp(klisp_State *K);
+
 /* init ground */
 void kinit_eqp_ground_env(klisp_State *K);
 
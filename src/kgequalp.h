@@ -9,6 +9,9 @@
 
 #include "kstate.h"
 
+/* 4.3.1 equal? (used in kgpairs_lists for fast paths) */
+void equalp(klisp_State *K);
+
 /* init ground */
 void kinit_equalp_ground_env(klisp_State *K);
 
@@ -8,6 +8,7 @@
 #include <stdio.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
 
 #include "kghelpers.h"
 #include "kstate.h"
@@ -22,10 +23,12 @@
 #include "kbytevector.h"
 #include "kvector.h"
 #include "kstring.h"
+#include "kslice.h"
 #include "kpair.h"
 #include "kcontinuation.h"
 #include "kencapsulation.h"
 #include "kpromise.h"
+#include "kprofile.h"
 
 /* XXX lock? */
 /* Initialization of continuation names */
@@ -35,10 +38,7 @@ void kinit_kghelpers_cont_names(klisp_State *K)
     add_cont_name(K, t, do_seq, "eval-sequence");
     add_cont_name(K, t, do_pass_value, "pass-value");
     add_cont_name(K, t, do_return_value, "return-value");
-    add_cont_name(K, t, do_bind, "dynamic-bind");
-    add_cont_name(K, t, do_bind, "dynamic-access");
-    add_cont_name(K, t, do_bind, "dynamic-unbind");
-    add_cont_name(K, t, do_bind, "dynamic-set!-pass");
+    add_cont_name(K, t, do_unbind, "dynamic-unbind");
 }
 
 /* Type predicates */
@@ -88,26 +88,23 @@ void enc_typep(klisp_State *K)
     */
     TValue key = xparams[0];
 
-    /* check the ptree is a list while checking the predicate.
-       Keep going even if the result is false to catch errors in 
-       ptree structure */
-    bool res = true;
-
-    TValue tail = ptree;
-    while(ttispair(tail) && kis_unmarked(tail)) {
-        kmark(tail);
-        res &= kis_encapsulation_type(kcar(tail), key);
-        tail = kcdr(tail);
-    }
-    unmark_list(K, ptree);
-
-    if (ttispair(tail) || ttisnil(tail)) {
-        kapply_cc(K, b2tv(res));
-    } else {
+    /* check the ptree is a list first (structure errors take
+       precedence), then the predicate can stop at the first false */
+    int32_t pairs;
+    TValue tail = list_metrics(ptree, &pairs, NULL);
+    if (!ttispair(tail) && !ttisnil(tail)) {
         /* try to get name from encapsulation */
         klispE_throw_simple(K, "expected list");
         return;
     }
+
+    bool res = true;
+    tail = ptree;
+    while(res && pairs-- > 0) {
+        res = kis_encapsulation_type(kcar(tail), key);
+        tail = kcdr(tail);
+    }
+    kapply_cc(K, b2tv(res));
 }
 /* /Type predicates */
 
@@ -168,25 +165,22 @@ void typep(klisp_State *K)
     UNUSED(denv);
     int32_t tag = ivalue(xparams[1]);
 
-    /* check the ptree is a list while checking the predicate.
-       Keep going even if the result is false to catch errors in 
-       ptree structure */
-    bool res = true;
-
-    TValue tail = ptree;
-    while(ttispair(tail) && kis_unmarked(tail)) {
-        kmark(tail);
-        res &= ttype(kcar(tail)) == tag;
-        tail = kcdr(tail);
-    }
-    unmark_list(K, ptree);
-
-    if (ttispair(tail) || ttisnil(tail)) {
-        kapply_cc(K, b2tv(res));
-    } else {
+    /* check the ptree is a list first (structure errors take
+       precedence), then the predicate can stop at the first false */
+    int32_t pairs;
+    TValue tail = list_metrics(ptree, &pairs, NULL);
+    if (!ttispair(tail) && !ttisnil(tail)) {
         klispE_throw_simple(K, "expected list");
         return;
     }
+
+    bool res = true;
+    tail = ptree;
+    while(res && pairs-- > 0) {
+        res = ttype(kcar(tail)) == tag;
+        tail = kcdr(tail);
+    }
+    kapply_cc(K, b2tv(res));
 }
 
 void ftypep(klisp_State *K)
@@ -202,25 +196,22 @@ void ftypep(klisp_State *K)
     */
     bool (*fn)(TValue obj) = pvalue(xparams[1]);
 
-    /* check the ptree is a list while checking the predicate.
-       Keep going even if the result is false to catch errors in 
-       ptree structure */
-    bool res = true;
-
-    TValue tail = ptree;
-    while(ttispair(tail) && kis_unmarked(tail)) {
-        kmark(tail);
-        res &= (*fn)(kcar(tail));
-        tail = kcdr(tail);
-    }
-    unmark_list(K, ptree);
-
-    if (ttispair(tail) || ttisnil(tail)) {
-        kapply_cc(K, b2tv(res));
-    } else {
+    /* check the ptree is a list first (structure errors take
+       precedence), then the predicate can stop at the first false */
+    int32_t pairs;
+    TValue tail = list_metrics(ptree, &pairs, NULL);
+    if (!ttispair(tail) && !ttisnil(tail)) {
         klispE_throw_simple(K, "expected list");
         return;
     }
+
+    bool res = true;
+    tail = ptree;
+    while(res && pairs-- > 0) {
+        res = (*fn)(kcar(tail));
+        tail = kcdr(tail);
+    }
+    kapply_cc(K, b2tv(res));
 }
 
 /*
@@ -386,28 +377,63 @@ void ftyped_kbpredp(klisp_State *K)
     kapply_cc(K, b2tv(res));
 }
 
-/* typed finite list. Structure error should be throw before type errors */
-void check_typed_list(klisp_State *K, bool (*typep)(TValue), bool allow_infp, 
-                      TValue obj, int32_t *pairs, int32_t *cpairs)
+TValue list_metrics(TValue obj, int32_t *pairs, int32_t *cpairs)
 {
-    TValue tail = obj;
+    /* first find the cycle length (if any) */
+    TValue tortoise = obj;
+    TValue hare = obj;
     int32_t p = 0;
-    bool type_errorp = false;
+    int32_t power = 1;
+    int32_t lam = 0;
 
-    while(ttispair(tail) && !kis_marked(tail)) {
-        /* even if there is a type error continue checking the structure */
-        type_errorp |= !(*typep)(kcar(tail));
-        kset_mark(tail, i2tv(p));
-        tail = kcdr(tail);
+    while(ttispair(hare)) {
+        hare = kcdr(hare);
         ++p;
+        ++lam;
+        if (tv_equal(hare, tortoise))
+            break;
+        if (lam == power) {
+            tortoise = hare;
+            power <<= 1;
+            lam = 0;
+        }
     }
 
+    if (!ttispair(hare)) {
+        /* acyclic list, p is the number of pairs */
+        if (pairs != NULL) *pairs = p;
+        if (cpairs != NULL) *cpairs = 0;
+        return hare;
+    }
+
+    /* cyclic list with a cycle of lam pairs, now find the first pair
+       of the cycle: start one pointer lam pairs ahead and advance both
+       until they meet */
+    tortoise = hare = obj;
+    for (int32_t i = 0; i < lam; ++i)
+        hare = kcdr(hare);
+
+    int32_t mu = 0;
+    while(!tv_equal(tortoise, hare)) {
+        tortoise = kcdr(tortoise);
+        hare = kcdr(hare);
+        ++mu;
+    }
+
+    if (pairs != NULL) *pairs = mu + lam;
+    if (cpairs != NULL) *cpairs = lam;
+    return tortoise;
+}
+
+/* typed finite list. Structure error should be throw before type errors */
+void check_typed_list(klisp_State *K, bool (*typep)(TValue), bool allow_infp, 
+                      TValue obj, int32_t *pairs, int32_t *cpairs)
+{
+    int32_t p;
+    TValue tail = list_metrics(obj, &p, cpairs);
+
     if (pairs != NULL) *pairs = p;
-    if (cpairs != NULL)
-        *cpairs = ttispair(tail)? (p - ivalue(kget_mark(tail))) : 0;
 
-    unmark_list(K, obj);
-    
     if (!ttispair(tail) && !ttisnil(tail)) {
         klispE_throw_simple(K, allow_infp? "expected list" :
                             "expected finite list"); 
@@ -415,31 +441,24 @@ void check_typed_list(klisp_State *K, bool (*typep)(TValue), bool allow_infp,
     } else if(ttispair(tail) && !allow_infp) {
         klispE_throw_simple(K, "expected finite list"); 
         return;
-    } else if (type_errorp) {
-        /* TODO put type name too, should be extracted from a
-           table of type names */
-        klispE_throw_simple(K, "bad operand type"); 
-        return;
+    } 
+
+    tail = obj;
+    while(p-- > 0) {
+        if (!(*typep)(kcar(tail))) {
+            /* TODO put type name too, should be extracted from a
+               table of type names */
+            klispE_throw_simple(K, "bad operand type"); 
+            return;
+        }
+        tail = kcdr(tail);
     }
 }
 
 void check_list(klisp_State *K, bool allow_infp, TValue obj, 
                 int32_t *pairs, int32_t *cpairs)
 {
-    TValue tail = obj;
-    int32_t p = 0;
-
-    while(ttispair(tail) && !kis_marked(tail)) {
-        kset_mark(tail, i2tv(p));
-        tail = kcdr(tail);
-        ++p;
-    }
-
-    if (pairs != NULL) *pairs = p;
-    if (cpairs != NULL)
-        *cpairs = ttispair(tail)? (p - ivalue(kget_mark(tail))) : 0;
-
-    unmark_list(K, obj);
+    TValue tail = list_metrics(obj, pairs, cpairs);
 
     if (!ttispair(tail) && !ttisnil(tail)) {
         klispE_throw_simple(K, allow_infp? "expected list" : 
@@ -455,7 +474,6 @@ void check_list(klisp_State *K, bool allow_infp, TValue obj,
 TValue check_copy_list(klisp_State *K, TValue obj, bool force_copy, 
                        int32_t *pairs, int32_t *cpairs)
 {
-    int32_t p = 0;
     if (ttisnil(obj)) {
         if (pairs != NULL) *pairs = 0;
         if (cpairs != NULL) *cpairs = 0;
@@ -467,45 +485,45 @@ TValue check_copy_list(klisp_State *K, TValue obj, bool force_copy,
         check_list(K, true, obj, pairs, cpairs);
         return obj;
     } else {
+        int32_t p, c;
+        TValue tail = list_metrics(obj, &p, &c);
+
+        if (!ttispair(tail) && !ttisnil(tail)) {
+            klispE_throw_simple(K, "expected list"); 
+            return KINERT;
+        } 
+
+        if (pairs != NULL) *pairs = p;
+        if (cpairs != NULL) *cpairs = c;
+
         TValue copy = kcons(K, KNIL, KNIL);
         krooted_vars_push(K, &copy);
         TValue last_pair = copy;
-        TValue tail = obj;
+        /* the copy of the first pair in the cycle (if any) */
+        TValue cycle_pair = KNIL;
+        krooted_vars_push(K, &cycle_pair);
+        int32_t apairs = p - c;
+        tail = obj;
     
-        while(ttispair(tail) && !kis_marked(tail)) {
+        for (int32_t i = 0; i < p; ++i) {
             TValue new_pair = kcons(K, kcar(tail), KNIL);
-            /* record the corresponding pair to simplify cycle handling */
-            kset_mark(tail, new_pair);
-            /* record the pair number in the new pair, to set cpairs */
-            kset_mark(new_pair, i2tv(p));
             /* copy the source code info */
             TValue si = ktry_get_si(K, tail);
             if (!ttisnil(si))
                 kset_source_info(K, new_pair, si);
             kset_cdr(last_pair, new_pair);
             last_pair = new_pair;
+            if (i == apairs)
+                cycle_pair = new_pair;
             tail = kcdr(tail);
-            ++p;
         }
 
-        if (pairs != NULL) *pairs = p;
-        if (cpairs != NULL)
-            *cpairs = ttispair(tail)? 
-                (p - ivalue(kget_mark(kget_mark(tail)))) : 
-                0;
-
-        if (ttispair(tail)) {
+        if (c > 0) {
             /* complete the cycle */
-            kset_cdr(last_pair, kget_mark(tail));
+            kset_cdr(last_pair, cycle_pair);
         }
 
-        unmark_list(K, obj);
-        unmark_list(K, kcdr(copy));
-        
-        if (!ttispair(tail) && !ttisnil(tail)) {
-            klispE_throw_simple(K, "expected list"); 
-            return KINERT;
-        } 
+        krooted_vars_pop(K);
         krooted_vars_pop(K);
         return kcdr(copy);
     }
@@ -655,16 +673,16 @@ TValue list_to_bytevector_h(klisp_State *K, TValue ls, int32_t length)
 /* GC: Assume array is rooted */
 TValue string_to_list_h(klisp_State *K, TValue obj, int32_t *length)
 {
-    if (!ttisstring(obj)) {
+    if (!ttisstrview(obj)) {
         klispE_throw_simple_with_irritants(K, "Bad type (expected string)",
                                            1, obj);
         return KINERT;
     }
 
-    int32_t pairs = kstring_size(obj);
+    int32_t pairs = kstrview_size(obj);
     if (length != NULL)	*length = pairs;
 
-    char *buf = kstring_buf(obj) + pairs - 1;
+    char *buf = kstrview_buf(obj) + pairs - 1;
     TValue tail = KNIL;
     krooted_vars_push(K, &tail);
     while(pairs-- > 0) {
@@ -677,38 +695,44 @@ TValue string_to_list_h(klisp_State *K, TValue obj, int32_t *length)
 
 TValue vector_to_list_h(klisp_State *K, TValue obj, int32_t *length)
 {
-    if (!ttisvector(obj)) {
+    int32_t pairs;
+    TValue *buf;
+    /* growable vectors are walked directly, without copying them
+       to a regular vector first */
+    if (ttisvector(obj)) {
+        pairs = kvector_size(obj);
+        buf = kvector_buf(obj);
+    } else if (ttisgvector(obj)) {
+        pairs = kgvector_size(obj);
+        buf = pairs == 0? NULL : kgvector_buf(obj);
+    } else {
         klispE_throw_simple_with_irritants(K, "Bad type (expected vector)",
                                            1, obj);
         return KINERT;
     }
 
-    int32_t pairs = kvector_size(obj);
     if (length != NULL)	*length = pairs;
 
-    TValue *buf = kvector_buf(obj) + pairs - 1;
     TValue tail = KNIL;
     krooted_vars_push(K, &tail);
-    while(pairs-- > 0) {
-        tail = kcons(K, *buf, tail);
-        --buf;
-    }
+    while(pairs-- > 0)
+        tail = kcons(K, buf[pairs], tail);
     krooted_vars_pop(K);
     return tail;
 }
 
 TValue bytevector_to_list_h(klisp_State *K, TValue obj, int32_t *length)
 {
-    if (!ttisbytevector(obj)) {
+    if (!ttisbvview(obj)) {
         klispE_throw_simple_with_irritants(K, "Bad type (expected bytevector)",
                                            1, obj);
         return KINERT;
     }
 
-    int32_t pairs = kbytevector_size(obj);
+    int32_t pairs = kbvview_size(obj);
     if (length != NULL)	*length = pairs;
 
-    uint8_t *buf = kbytevector_buf(obj) + pairs - 1;
+    uint8_t *buf = kbvview_buf(obj) + pairs - 1;
     TValue tail = KNIL;
     krooted_vars_push(K, &tail);
     while(pairs-- > 0) {
@@ -803,37 +827,13 @@ void list(klisp_State *K)
 void get_list_metrics_aux(klisp_State *K, TValue obj, int32_t *p, int32_t *n, 
                           int32_t *a, int32_t *c)
 {
-    TValue tail = obj;
-    int32_t pairs = 0;
-
-    while(ttispair(tail) && !kis_marked(tail)) {
-        /* record the pair number to simplify cycle pair counting */
-        kset_mark(tail, i2tv(pairs));
-        ++pairs;
-        tail = kcdr(tail);
-    }
-    int32_t apairs, cpairs, nils;
-    if (ttisnil(tail)) {
-        /* simple (possibly empty) list */
-        apairs = pairs;
-        nils = 1;
-        cpairs = 0;
-    } else if (ttispair(tail)) {
-        /* cyclic (maybe circular) list */
-        apairs = ivalue(kget_mark(tail));
-        cpairs = pairs - apairs;
-        nils = 0;
-    } else {
-        apairs = pairs;
-        cpairs = 0;
-        nils = 0;
-    }
-
-    unmark_list(K, obj);
+    UNUSED(K);
+    int32_t pairs, cpairs;
+    TValue tail = list_metrics(obj, &pairs, &cpairs);
 
     if (p != NULL) *p = pairs;
-    if (n != NULL) *n = nils;
-    if (a != NULL) *a = apairs;
+    if (n != NULL) *n = ttisnil(tail)? 1 : 0;
+    if (a != NULL) *a = pairs - cpairs;
     if (c != NULL) *c = cpairs;
 }
 
@@ -899,8 +899,12 @@ bool eq2p(klisp_State *K, TValue obj1, TValue obj2)
                (eq? obj1 obj2) */
             res = kbigrat_eqp(K, obj1, obj2);
             break;
-        } /* immutable strings & bytevectors are interned so they are 
-             covered already by tv_equalp */
+        case K_TSTRING:
+            /* long immutable strings aren't interned */
+            res = kstring_imm_eqp(obj1, obj2);
+            break;
+        } /* immutable bytevectors & short immutable strings are interned
+             so they are covered already by tv_equalp */
 
     }
     return res;
@@ -1027,9 +1031,26 @@ bool equal2p(klisp_State *K, TValue obj1, TValue obj2)
         obj1 = ks_spop(K);
 
         if (!eq2p(K, obj1, obj2)) {
-            /* This type comparison works because we just care about
-               pairs, vectors, strings & bytevectors */
-            if (ttype(obj1) == ttype(obj2)) {
+            /* slices are equal to the strings, bytevectors or slices
+               with the same contents */
+            if ((ttisslice(obj1) || ttisslice(obj2)) &&
+                ((ttisstrview(obj1) && ttisstrview(obj2)) ||
+                 (ttisbvview(obj1) && ttisbvview(obj2)))) {
+                bool strp = ttisstrview(obj1);
+                uint32_t size = strp? kstrview_size(obj1) : 
+                    kbvview_size(obj1);
+                const void *buf1 = strp? (void *) kstrview_buf(obj1) : 
+                    (void *) kbvview_buf(obj1);
+                const void *buf2 = strp? (void *) kstrview_buf(obj2) : 
+                    (void *) kbvview_buf(obj2);
+                if (size != (strp? kstrview_size(obj2) : kbvview_size(obj2))
+                    || memcmp(buf1, buf2, size) != 0) {
+                    result = false;
+                    goto end;
+                }
+            } else if (ttype(obj1) == ttype(obj2)) {
+                /* This type comparison works because we just care about
+                   pairs, vectors, strings & bytevectors */
                 switch(ttype(obj1)) {
                 case K_TPAIR:
                     /* if they were already compaired, consider equal for 
@@ -1197,7 +1218,8 @@ static inline void ptree_clear_all(klisp_State *K, TValue sym_ls)
 }
 
 /* GC: assumes env, ptree & obj are rooted */
-void match(klisp_State *K, TValue env, TValue ptree, TValue obj)
+static inline void match_aux(klisp_State *K, TValue env, TValue ptree, 
+                             TValue obj, bool newp)
 {
     assert(ks_sisempty(K));
     ks_spush(K, obj);
@@ -1220,7 +1242,10 @@ void match(klisp_State *K, TValue env, TValue ptree, TValue obj)
             /* do nothing */
             break;
         case K_TSYMBOL:
-            kadd_binding(K, env, ptree, obj);
+            if (newp)
+                kadd_new_binding(K, env, ptree, obj);
+            else
+                kadd_binding(K, env, ptree, obj);
             break;
         case K_TPAIR:
             if (ttispair(obj)) {
@@ -1242,6 +1267,56 @@ void match(klisp_State *K, TValue env, TValue ptree, TValue obj)
     }
 }
 
+void match(klisp_State *K, TValue env, TValue ptree, TValue obj)
+{
+    match_aux(K, env, ptree, obj, false);
+}
+
+bool ptree_flatp(TValue ptree)
+{
+    /* ptree has no cycles (checked by check_copy_ptree) */
+    while(ttispair(ptree)) {
+        TValue first = kcar(ptree);
+        if (!ttissymbol(first) && !ttisignore(first))
+            return false;
+        ptree = kcdr(ptree);
+    }
+    return true;
+}
+
+/* GC: assumes env, ptree & obj are rooted */
+void match_new(klisp_State *K, TValue env, TValue ptree, bool flatp, 
+               TValue obj)
+{
+    if (!flatp) {
+        match_aux(K, env, ptree, obj, true);
+        return;
+    }
+
+    /* flat ptree, no need to use the stack, obj pairs remain rooted
+       through obj */
+    while(ttispair(ptree)) {
+        if (!ttispair(obj)) {
+            /* TODO show ptree and arguments */
+            klispE_throw_simple(K, "ptree doesn't match arguments");
+            return;
+        }
+        TValue first = kcar(ptree);
+        if (ttissymbol(first))
+            kadd_new_binding(K, env, first, kcar(obj));
+        ptree = kcdr(ptree);
+        obj = kcdr(obj);
+    }
+
+    if (ttissymbol(ptree)) {
+        kadd_new_binding(K, env, ptree, obj);
+    } else if (ttisnil(ptree) && !ttisnil(obj)) {
+        /* TODO show ptree and arguments */
+        klispE_throw_simple(K, "ptree doesn't match arguments");
+        return;
+    }
+}
+
 /* GC: assumes ptree & penv are rooted */
 TValue check_copy_ptree(klisp_State *K, TValue ptree, TValue penv)
 {
@@ -1583,6 +1658,84 @@ TValue map_for_each_transpose(klisp_State *K, TValue lss,
     return kcdr(tlist);
 }
 
+/* Return the operand list for the next call to the applicative in a 
+   streaming map/for-each, and replace *tails with the remaining lists.
+   See kghelpers.h */
+
+/* GC: assumes *tails is rooted */
+TValue map_for_each_next(klisp_State *K, TValue *tails, int32_t n)
+{
+    if (n == 1) {
+        /* the common case, no list of tails needed */
+        TValue ls = *tails;
+        if (!ttispair(ls)) {
+            klispE_throw_simple(K, "list mutated during map/for-each");
+            return KINERT;
+        }
+        *tails = kcdr(ls);
+        return kcons(K, kcar(ls), KNIL);
+    }
+
+    TValue cars = kcons(K, KNIL, KNIL);
+    krooted_vars_push(K, &cars);
+    TValue lp_cars = cars;
+
+    TValue cdrs = kcons(K, KNIL, KNIL);
+    krooted_vars_push(K, &cdrs);
+    TValue lp_cdrs = cdrs;
+
+    TValue tail = *tails;
+    while(n--) {
+        TValue ls = kcar(tail);
+        tail = kcdr(tail);
+        if (!ttispair(ls)) {
+            klispE_throw_simple(K, "list mutated during map/for-each");
+            return KINERT;
+        }
+
+        TValue np;
+        np = kcons(K, kcar(ls), KNIL);
+        kset_cdr(lp_cars, np);
+        lp_cars = np;
+
+        np = kcons(K, kcdr(ls), KNIL);
+        kset_cdr(lp_cdrs, np);
+        lp_cdrs = np;
+    }
+
+    krooted_vars_pop(K);
+    krooted_vars_pop(K);
+    *tails = kcdr(cdrs);
+    return kcdr(cars);
+}
+
+/* Call the operative underlying app and check if it returned directly
+   to frame. See kghelpers.h */
+
+/* GC: assumes frame & ptree are rooted or reachable from K */
+bool kcall_direct(klisp_State *K, TValue frame, TValue app, TValue ptree,
+                  TValue denv, TValue *value)
+{
+    TValue op = kunwrap(app);
+    klisp_assert(ttisoperative(op));
+
+    kset_cc(K, frame);
+    klispT_tail_call_si(K, op, ptree, denv, ktry_get_si(K, op));
+    (*(K->next_func))(K);
+    /* the same that klispT_run does after each call */
+    if (klispP_tick)
+        klispP_sample(K);
+    klispi_threadyield(K);
+
+    /* a return has a nil next_env (see klispT_apply_cc) */
+    if (tv_equal(K->next_obj, frame) && ttisnil(K->next_env)) {
+        *value = K->next_value;
+        return true;
+    } else {
+        return false;
+    }
+}
+
 /* Continuations that are used in more than one file */
 
 /* Helper for $sequence, $vau, $lambda, ... */
@@ -1648,6 +1801,9 @@ void do_return_value(klisp_State *K)
 }
 
 /* binder returned */
+/* The binding continuation is also the binding itself (see kstate.h),
+   so binding is just a push and it is automatically undone on normal 
+   return and on abnormal passes (when the dynamic bindings are restored) */
 void do_bind(klisp_State *K)
 {
     TValue *xparams = K->next_xparams;
@@ -1661,25 +1817,11 @@ void do_bind(klisp_State *K)
 	         "combiner", ttiscombiner, comb);
     UNUSED(denv); /* the combiner is called in an empty environment */
     TValue key = xparams[0];
-    /* GC: root intermediate objs */
-    TValue new_flag = KTRUE;
-    TValue new_value = obj;
-    TValue old_flag = kcar(key);
-    TValue old_value = kcdr(key);
-    /* set the var to the new object */
-    kset_car(key, new_flag);
-    kset_cdr(key, new_value);
-    /* Old value must be protected from GC. It is no longer
-       reachable through key and not yet reachable through
-       continuation xparams. Boolean flag needn't be rooted,
-       because is not heap-allocated. */
-    krooted_tvs_push(K, old_value);
-    /* create a continuation to set the var to the correct value/flag on both
-       normal return and abnormal passes */
-    TValue new_cont = make_bind_continuation(K, key, old_flag, old_value,
-                                             new_flag, new_value);
-    krooted_tvs_pop(K);
+    TValue new_cont = kmake_continuation(K, kget_cc(K), do_unbind, 3, 
+                                         key, obj, K->kd_bindings);
+    kset_dyn_cont(new_cont);
     kset_cc(K, new_cont); /* implicit rooting */
+    K->kd_bindings = new_cont;
     TValue env = kmake_empty_environment(K);
     krooted_tvs_push(K, env);
     TValue expr = kcons(K, comb, KNIL);
@@ -1700,16 +1842,17 @@ void do_access(klisp_State *K)
     check_0p(K, ptree);
     UNUSED(denv);
     TValue key = xparams[0];
+    TValue value;
 
-    if (kis_true(kcar(key))) {
-        kapply_cc(K, kcdr(key));
+    if (klispT_kd_lookup(K, key, &value)) {
+        kapply_cc(K, value);
     } else {
         klispE_throw_simple(K, "variable is unbound");
         return;
     }
 }
 
-/* continuation to set the key to the old value on normal return */
+/* continuation to pop the binding on normal return */
 void do_unbind(klisp_State *K)
 {
     TValue *xparams = K->next_xparams;
@@ -1717,105 +1860,17 @@ void do_unbind(klisp_State *K)
     klisp_assert(ttisnil(K->next_env));
     /*
     ** xparams[0]: dynamic key
-    ** xparams[1]: old flag
-    ** xparams[2]: old value
+    ** xparams[1]: value
+    ** xparams[2]: previous bindings
     */
 
-    TValue key = xparams[0];
-    TValue old_flag = xparams[1];
-    TValue old_value = xparams[2];
-
-    kset_car(key, old_flag);
-    kset_cdr(key, old_value);
+    K->kd_bindings = xparams[2];
     /* pass along the value returned to this continuation */
     kapply_cc(K, obj);
 }
 
-/* operative for setting the key to the new/old flag/value */
-void do_set_pass(klisp_State *K)
-{
-    TValue *xparams = K->next_xparams;
-    TValue ptree = K->next_value;
-    TValue denv = K->next_env;
-    klisp_assert(ttisenvironment(K->next_env));
-    /*
-    ** xparams[0]: dynamic key
-    ** xparams[1]: flag
-    ** xparams[2]: value
-    */
-    TValue key = xparams[0];
-    TValue flag = xparams[1];
-    TValue value = xparams[2];
-    UNUSED(denv);
-
-    kset_car(key, flag);
-    kset_cdr(key, value);
-
-    /* pass to next interceptor/ final destination */
-    /* ptree is as for interceptors: (obj divert) */
-    TValue obj = kcar(ptree);
-    kapply_cc(K, obj);
-}
-
 /* /Continuations that are used in more than one file */
 
-/* dynamic keys */
-/* create continuation to set the key on both normal return and
-   abnormal passes */
-/* TODO: reuse the code for guards in kgcontinuations.c */
-
-/* GC: this assumes that key, old_value and new_value are rooted */
-TValue make_bind_continuation(klisp_State *K, TValue key,
-                              TValue old_flag, TValue old_value, 
-                              TValue new_flag, TValue new_value)
-{
-    TValue unbind_cont = kmake_continuation(K, kget_cc(K), 
-                                            do_unbind, 3, key, old_flag, 
-                                            old_value);
-    krooted_tvs_push(K, unbind_cont);
-    /* create the guards to guarantee that the values remain consistent on
-       abnormal passes (in both directions) */
-    TValue exit_int = kmake_operative(K, do_set_pass, 
-                                      3, key, old_flag, old_value);
-    krooted_tvs_push(K, exit_int);
-    TValue exit_guard = kcons(K, G(K)->root_cont, exit_int);
-    krooted_tvs_pop(K); /* already rooted in guard */
-    krooted_tvs_push(K, exit_guard);
-    TValue exit_guards = kcons(K, exit_guard, KNIL);
-    krooted_tvs_pop(K); /* already rooted in guards */
-    krooted_tvs_push(K, exit_guards);
-
-    TValue entry_int = kmake_operative(K, do_set_pass, 
-                                       3, key, new_flag, new_value);
-    krooted_tvs_push(K, entry_int);
-    TValue entry_guard = kcons(K, G(K)->root_cont, entry_int);
-    krooted_tvs_pop(K); /* already rooted in guard */
-    krooted_tvs_push(K, entry_guard);
-    TValue entry_guards = kcons(K, entry_guard, KNIL);
-    krooted_tvs_pop(K); /* already rooted in guards */
-    krooted_tvs_push(K, entry_guards);
-
-
-    /* NOTE: in the stack now we have the unbind cont & two guard lists */
-    /* this is needed for interception code */
-    TValue env = kmake_empty_environment(K);
-    krooted_tvs_push(K, env);
-    TValue outer_cont = kmake_continuation(K, unbind_cont, 
-                                           do_pass_value, 2, entry_guards, env);
-    kset_outer_cont(outer_cont);
-    krooted_tvs_push(K, outer_cont);
-    TValue inner_cont = kmake_continuation(K, outer_cont, 
-                                           do_pass_value, 2, exit_guards, env);
-    kset_inner_cont(inner_cont);
-
-    /* unbind_cont & 2 guard_lists */
-    krooted_tvs_pop(K); krooted_tvs_pop(K); krooted_tvs_pop(K);
-    /* env & outer_cont */
-    krooted_tvs_pop(K); krooted_tvs_pop(K);
-    
-    return inner_cont;
-}
-
 /* Helpers for guard-continuation (& guard-dynamic-extent) */
 
 #define singly_wrapped(obj_) (ttisapplicative(obj_) &&      \
@@ -343,6 +343,13 @@ static inline void unmark_tree(klisp_State *K, TValue obj)
 ** Structure checking and copying
 */
 
+/* Calculate the number of pairs in obj and the number of those that
+   are in a cycle (0 if the list is acyclic), returns the object that
+   terminates the list (the first pair of the cycle if it is cyclic).
+   This doesn't mark the pairs (it uses Brent's cycle detection) so
+   it only reads the list */
+TValue list_metrics(TValue obj, int32_t *pairs, int32_t *cpairs);
+
 /* TODO: move all bools to a flag parameter (with constants like
    KCHK_LS_FORCE_COPY, KCHK_ALLOW_CYCLE, KCHK_AVOID_ENCYCLE, etc) */
 /* typed finite list. Structure error are thrown before type errors */
@@ -426,14 +433,8 @@ void do_return_value(klisp_State *K);
 void do_bind(klisp_State *K);
 void do_access(klisp_State *K);
 void do_unbind(klisp_State *K);
-void do_set_pass(klisp_State *K);
 /* /Continuations that are used in more than one file */
 
-/* dynamic var */
-TValue make_bind_continuation(klisp_State *K, TValue key,
-                              TValue old_flag, TValue old_value, 
-                              TValue new_flag, TValue new_value);
-
 TValue check_copy_guards(klisp_State *K, char *name, TValue obj);
 void guard_dynamic_extent(klisp_State *K);
 
@@ -487,6 +488,15 @@ TValue copy_es_immutable_h(klisp_State *K, TValue ptree, bool mut_flag);
 /* ptree handling */
 void match(klisp_State *K, TValue env, TValue ptree, TValue obj);
 TValue check_copy_ptree(klisp_State *K, TValue ptree, TValue penv);
+/* the binding plan of a ptree (as returned by check_copy_ptree) */
+/* a flat ptree is a list of symbols and/or #ignores, possibly with a
+   symbol or #ignore as tail (this includes (), #ignore & symbols) */
+bool ptree_flatp(TValue ptree);
+/* like match, but env should be new (with no bindings for the symbols
+   in ptree), so no lookups are needed, flatp should be the result of
+   ptree_flatp(ptree) */
+void match_new(klisp_State *K, TValue env, TValue ptree, bool flatp, 
+               TValue obj);
 
 /* map/$for-each */
 /* Helpers for map (also used by for-each) */
@@ -512,6 +522,51 @@ TValue map_for_each_transpose(klisp_State *K, TValue lss,
                               int32_t app_apairs, int32_t app_cpairs, 
                               int32_t res_apairs, int32_t res_cpairs);
 
+/* Streaming map/for-each, used instead of transposing when the list of 
+   lists is acyclic: the n lists are walked in lockstep. *tails should
+   be the remaining list if n is 1, or a list of the n remaining lists
+   otherwise. Returns a new operand list for the next call to the 
+   applicative and replaces *tails with the remaining lists. *tails
+   is never mutated (a new list of tails is made if n > 1), so it can
+   be kept in a continuation. The lists themselves aren't copied, so
+   they are checked for structure on each step */
+/* GC: Assumes *tails is rooted */
+TValue map_for_each_next(klisp_State *K, TValue *tails, int32_t n);
+
+/* Call the operative underlying app with ptree in denv, with frame as
+   the current continuation, and run it right away (doing what the
+   main loop does after each call). Returns true and puts the result in
+   *value if the operative returned a value to frame directly (as most
+   primitives do). Otherwise returns false: K is left ready for the main
+   loop to continue and frame may have been captured, so it shouldn't be
+   mutated any more. This allows a streaming map/for-each to reuse a
+   single frame (mutating its xparams) while the calls return directly.
+   app should wrap an operative, and frame's parent should be the
+   continuation to return to once done */
+/* GC: Assumes frame & ptree are rooted or reachable from K */
+bool kcall_direct(klisp_State *K, TValue frame, TValue app, TValue ptree,
+                  TValue denv, TValue *value);
+
+/* Call an applicative with an already evaluated operand list.
+   If app wraps an operative there's no need to build and evaluate a
+   combination (that also has to unwrap the applicative to avoid extra 
+   evaluation of the operands). 
+   NOTE: this is a macro that returns (like ktail_eval) */
+/* GC: ptree is rooted while building the combination */
+#define ktail_apply_ptree(K_, app_, ptree_, denv_)                      \
+    { klisp_State *K___ = (K_);                                         \
+        TValue comb___ = kunwrap(app_);                                 \
+        TValue ptree___ = (ptree_);                                     \
+        TValue denv___ = (denv_);                                       \
+        if (ttisoperative(comb___)) {                                   \
+            ktail_call(K___, comb___, ptree___, denv___);               \
+        } else {                                                        \
+            krooted_tvs_push(K___, ptree___);                           \
+            TValue expr___ = kcons(K___, comb___, ptree___);            \
+            krooted_tvs_pop(K___);                                      \
+            ktail_eval(K___, expr___, denv___);                         \
+        } }
+
 
 /* for thread continuation guarding */
 void do_int_mark_root(klisp_State *K);
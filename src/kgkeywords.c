@@ -16,6 +16,7 @@
 #include "kstring.h"
 #include "ksymbol.h"
 #include "kkeyword.h"
+#include "kslice.h"
 #include "kerror.h"
 
 #include "kghelpers.h"
@@ -47,9 +48,11 @@ void string_to_keyword(klisp_State *K)
     klisp_assert(ttisenvironment(K->next_env));
     UNUSED(xparams);
     UNUSED(denv);
-    bind_1tp(K, ptree, "string", ttisstring, str);
+    bind_1tp(K, ptree, "string", ttisstrview, str);
     /* If the string is mutable it is copied */
-    TValue new_keyw = kkeyword_new_str(K, str);
+    /* slices are interned directly from the chars of the parent */
+    TValue new_keyw = ttisstring(str)? kkeyword_new_str(K, str) :
+        kkeyword_new_bs(K, kstrview_buf(str), kstrview_size(str));
     kapply_cc(K, new_keyw);
 }
 
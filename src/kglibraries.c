@@ -19,6 +19,9 @@
 #include "kpair.h"
 #include "kenvironment.h"
 #include "kkeyword.h"
+#include "ktable.h"
+#include "kstring.h"
+#include "ksymbol.h"
 
 #include "kghelpers.h"
 #include "kglibraries.h"
@@ -123,19 +126,82 @@ static void check_library_name(klisp_State *K, TValue name)
     check_typed_list(K, valid_name_partp, false, name, NULL, NULL);
 }
 
-static TValue libraries_registry_assoc(klisp_State *K, TValue name, TValue *lastp)
+/*
+** The registry is a table indexed by a structural hash of the library
+** names, so that a lookup doesn't have to compare the name with those
+** of all the registered libraries.  The value for each hash is a list
+** of the (name . library) entries with that hash (usually only one).
+*/
+static int32_t library_name_hash(TValue name)
+{
+    uint32_t h = 0;
+    for (; !ttisnil(name); name = kcdr(name)) {
+        TValue part = kcar(name);
+        /* bigints are rare in names, they all hash the same */
+        uint32_t ph = ttissymbol(part)? kstring_hash(ksymbol_str(part)) :
+            ttisfixint(part)? (uint32_t) ivalue(part) : 0x9e3779b9u;
+        h ^= ph + 0x9e3779b9u + (h << 6) + (h >> 2);
+    }
+    return (int32_t) h;
+}
+
+/* returns the (name . library) entry, or () if name isn't registered */
+static TValue libraries_registry_assoc(klisp_State *K, TValue name)
+{
+    const TValue *node = 
+        klispH_getfixint(tv2table(G(K)->libraries_registry),
+                         library_name_hash(name));
+    if (ttisfree(*node))
+        return KNIL;
+
+    for (TValue ls = *node; !ttisnil(ls); ls = kcdr(ls)) {
+        if (equal2p(K, kcar(kcar(ls)), name))
+            return kcar(ls);
+    }
+    return KNIL;
+}
+
+/* GC: Assumes name & library are rooted */
+static void libraries_registry_add(klisp_State *K, TValue name, 
+                                   TValue library)
+{
+    Table *t = tv2table(G(K)->libraries_registry);
+    int32_t hash = library_name_hash(name);
+    TValue np = kcons(K, name, library);
+    krooted_tvs_push(K, np);
+    const TValue *node = klispH_getfixint(t, hash);
+    np = kcons(K, np, ttisfree(*node)? KNIL : *node);
+    krooted_tvs_pop(K);
+    krooted_tvs_push(K, np);
+    TValue *slot = klispH_setfixint(K, t, hash);
+    *slot = np;
+    krooted_tvs_pop(K);
+}
+
+/* returns false if name wasn't registered */
+static bool libraries_registry_remove(klisp_State *K, TValue name)
 {
+    Table *t = tv2table(G(K)->libraries_registry);
+    int32_t hash = library_name_hash(name);
+    const TValue *node = klispH_getfixint(t, hash);
+    if (ttisfree(*node))
+        return false;
+
     TValue last = KNIL;
-    TValue res = KNIL;
-    for (TValue ls = G(K)->libraries_registry; !ttisnil(ls); last = ls, 
-             ls = kcdr(ls)) {
+    for (TValue ls = *node; !ttisnil(ls); last = ls, ls = kcdr(ls)) {
         if (equal2p(K, kcar(kcar(ls)), name)) {
-            res = kcar(ls);
-            break;
+            if (!ttisnil(last)) {
+                kset_cdr(last, kcdr(ls));
+            } else {
+                /* the key is already in the table, this doesn't 
+                   allocate */
+                TValue *slot = klispH_setfixint(K, t, hash);
+                *slot = ttisnil(kcdr(ls))? KFREE : kcdr(ls);
+            }
+            return true;
         }
     }
-    if (lastp != NULL) *lastp = last;
-    return res;
+    return false;
 }
 
 /* ?.? $registered-library? */
@@ -143,7 +209,7 @@ static void Sregistered_libraryP(klisp_State *K)
 {
     bind_1p(K, K->next_value, name);
     check_library_name(K, name);
-    TValue entry = libraries_registry_assoc(K, name, NULL);
+    TValue entry = libraries_registry_assoc(K, name);
     kapply_cc(K, ttisnil(entry)? KFALSE : KTRUE);
 }
 
@@ -152,7 +218,7 @@ static void Sget_registered_library(klisp_State *K)
 {
     bind_1p(K, K->next_value, name);
     check_library_name(K, name);
-    TValue entry = libraries_registry_assoc(K, name, NULL);
+    TValue entry = libraries_registry_assoc(K, name);
     if (ttisnil(entry)) {
         klispE_throw_simple_with_irritants(K, "Unregistered library name",
                                            1, name);
@@ -172,17 +238,14 @@ static void do_register_library(klisp_State *K)
         return;
     }
     TValue name = K->next_xparams[0];
-    TValue entry = libraries_registry_assoc(K, name, NULL);
+    TValue entry = libraries_registry_assoc(K, name);
     if (!ttisnil(entry)) {
         klispE_throw_simple_with_irritants(K, "library name already registered",
                                            1, name);
         return;
     }
-    TValue np = kcons(K, name, obj);
-    krooted_tvs_push(K, np);
-    np = kcons(K, np, G(K)->libraries_registry);
-    G(K)->libraries_registry = np;
-    krooted_tvs_pop(K);
+    /* obj is rooted because it's K->next_value */
+    libraries_registry_add(K, name, obj);
     kapply_cc(K, KINERT);
 }
 
@@ -207,18 +270,11 @@ static void Sunregister_libraryB(klisp_State *K)
 {
     bind_1p(K, K->next_value, name);
     check_library_name(K, name);
-    TValue last;
-    TValue entry = libraries_registry_assoc(K, name, &last);
-    if (ttisnil(entry)) {
+    if (!libraries_registry_remove(K, name)) {
         klispE_throw_simple_with_irritants(K, "library name not registered",
                                            1, name);
         return;
     }
-    if (ttisnil(last)) { /* it's in the first pair */
-        G(K)->libraries_registry = kcdr(G(K)->libraries_registry);
-    } else {
-        kset_cdr(last, kcdr(kcdr(last)));
-    }
     kapply_cc(K, KINERT);
 }
 
@@ -300,7 +356,7 @@ static void do_provide_library(klisp_State *K)
     */
     TValue name = K->next_xparams[0];
 
-    if (!ttisnil(libraries_registry_assoc(K, name, NULL))) {
+    if (!ttisnil(libraries_registry_assoc(K, name))) {
         klispE_throw_simple_with_irritants(K, "library name already registered",
                                            1, name);
         return;
@@ -327,13 +383,8 @@ static void do_provide_library(klisp_State *K)
     TValue library = kmake_library(K, new_env, enames);
     krooted_tvs_pop(K); /* new_env */
     krooted_tvs_push(K, library);
-
-    TValue np = kcons(K, name, library);
+    libraries_registry_add(K, name, library);
     krooted_tvs_pop(K); /* library */
-    krooted_tvs_push(K, np);
-    np = kcons(K, np, G(K)->libraries_registry);
-    G(K)->libraries_registry = np;
-    krooted_tvs_pop(K);
     kapply_cc(K, KINERT);
 }
 
@@ -376,7 +427,7 @@ static void Sprovide_libraryB(klisp_State *K)
     body = copy_es_immutable_h(K, body, false);
     krooted_tvs_push(K, body);
 
-    if (!ttisnil(libraries_registry_assoc(K, name, NULL))) {
+    if (!ttisnil(libraries_registry_assoc(K, name))) {
         klispE_throw_simple_with_irritants(K, "library name already registered",
                                            1, name);
         return;
@@ -545,7 +596,7 @@ static TValue extract_import_bindings(klisp_State *K, TValue imports)
                 stack = kcons(K, clause, stack);
                 clause = kcar(kcdr(clause));
             }
-            TValue entry = libraries_registry_assoc(K, clause, NULL);
+            TValue entry = libraries_registry_assoc(K, clause);
             if (ttisnil(entry)) {
                 klispE_throw_simple_with_irritants(K, "library name not "
                                                    "registered", 1, clause);
@@ -725,6 +776,63 @@ static void Simport_libraryB(klisp_State *K)
     kapply_cc(K, KINERT);
 }
 
+/* ?.? $import-environment */
+/* This doesn't copy the bindings of the imported libraries: for each
+   import clause that is just a library name, the environment of the 
+   library (that has only the exported bindings) is used directly as a 
+   parent of the new environment.  The other clauses get a table 
+   environment with the bindings they select.  If a symbol is imported
+   more than once, the first clause wins (like in any environment with
+   many parents) */
+static void Simport_environment(klisp_State *K)
+{
+    TValue imports = K->next_value;
+
+    check_import_list(K, imports);
+
+    TValue parents = kcons(K, KNIL, KNIL);
+    TValue lp = parents;
+    krooted_tvs_push(K, parents);
+    TValue obj = KNIL;
+    krooted_vars_push(K, &obj);
+
+    for (; !ttisnil(imports); imports = kcdr(imports)) {
+        TValue clause = kcar(imports);
+        if (ttiskeyword(kcar(clause))) {
+            obj = kcons(K, clause, KNIL);
+            /* list of (name . value) pairs */
+            obj = extract_import_bindings(K, obj);
+            TValue env = kmake_table_environment(K, KNIL);
+            krooted_tvs_push(K, env);
+            for (TValue ls = obj; !ttisnil(ls); ls = kcdr(ls))
+                kadd_binding(K, env, kcar(kcar(ls)), kcdr(kcar(ls)));
+            obj = env;
+            krooted_tvs_pop(K);
+        } else {
+            TValue entry = libraries_registry_assoc(K, clause);
+            if (ttisnil(entry)) {
+                klispE_throw_simple_with_irritants(K, "library name not "
+                                                   "registered", 1, clause);
+                return;
+            }
+            obj = klibrary_env(kcdr(entry));
+        }
+        TValue np = kcons(K, obj, KNIL);
+        kset_cdr(lp, np);
+        lp = np;
+    }
+
+    parents = kcdr(parents);
+    /* use the env directly if there is only one parent, like 
+       make-environment */
+    TValue new_env = kmake_environment(K, ttispair(parents) && 
+                                       ttisnil(kcdr(parents))? 
+                                       kcar(parents) : parents);
+    krooted_vars_pop(K);
+    krooted_tvs_pop(K);
+    kapply_cc(K, new_env);
+}
+
 /* init ground */
 void kinit_libraries_ground_env(klisp_State *K)
 {
@@ -750,6 +858,8 @@ void kinit_libraries_ground_env(klisp_State *K)
 
     add_operative(K, ground_env, "$provide-library!", Sprovide_libraryB, 0);
     add_operative(K, ground_env, "$import-library!", Simport_libraryB, 0);
+    add_operative(K, ground_env, "$import-environment", 
+                  Simport_environment, 0);
 }
 
 /* XXX lock? */
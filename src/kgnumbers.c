@@ -27,6 +27,7 @@
 #include "kinteger.h"
 #include "krational.h"
 #include "kreal.h"
+#include "kslice.h"
 
 #include "kghelpers.h"
 #include "kgnumbers.h"
@@ -2407,14 +2408,20 @@ void string_to_number(klisp_State *K)
     UNUSED(denv);
     UNUSED(xparams);
 
-    bind_al1tp(K, ptree, "string", ttisstring, str, maybe_radix);
+    bind_al1tp(K, ptree, "string", ttisstrview, str, maybe_radix);
     int radix = 10;
     if (get_opt_tpar(K, maybe_radix, "radix (2, 8, 10, or 16)", ttisradix))
         radix = ivalue(maybe_radix); 
 
+    /* the chars of slices are copied, because the parsing below relies 
+       on the final '\0' (the slice is still used in the error msgs) */
+    TValue chars = ttisstring(str)? str : 
+        kstring_new_bs(K, kstrview_buf(str), kstrview_size(str));
+    krooted_tvs_push(K, chars);
+
     /* track length to throw better error msgs */
-    char *buf = kstring_buf(str);
-    int32_t len = kstring_size(str);
+    char *buf = kstring_buf(chars);
+    int32_t len = kstring_size(chars);
 
     /* if at some point we reach the end of the string
        the char will be '\0' and will fail all tests,
@@ -2494,6 +2501,7 @@ void string_to_number(klisp_State *K)
             krooted_tvs_pop(K);
         }
     }
+    krooted_tvs_pop(K);
     kapply_cc(K, res);
 }
 
@@ -9,6 +9,13 @@
 
 #include "kstate.h"
 
+/* 12.5.4 + & 12.5.5 * (used in kgpairs_lists for fast paths) */
+void kplus(klisp_State *K);
+void ktimes(klisp_State *K);
+/* may throw an error on no primary value */
+TValue knum_plus(klisp_State *K, TValue n1, TValue n2);
+TValue knum_times(klisp_State *K, TValue n1, TValue n2);
+
 /* init ground */
 void kinit_numbers_ground_env(klisp_State *K);
 
@@ -18,8 +18,13 @@
 #include "kenvironment.h"
 #include "ksymbol.h"
 #include "kerror.h"
+#include "kapplicative.h"
+#include "koperative.h"
 
 #include "kghelpers.h"
+#include "kgeqp.h"
+#include "kgequalp.h"
+#include "kgnumbers.h"
 #include "kgpairs_lists.h"
 
 /* Continuations */
@@ -33,6 +38,112 @@ void do_reduce_postc(klisp_State *K);
 void do_reduce_combine(klisp_State *K);
 void do_reduce_cycle(klisp_State *K);
 
+/*
+** Fast paths for primitive combiners.
+** When the applicative passed to filter, assoc, member? or reduce wraps
+** (exactly once) an operative implemented by one of the C functions 
+** below, the whole loop can be done here in C, without building an 
+** expression and a continuation for each element. This is safe because 
+** these primitives don't capture continuations or mutate the list, and
+** they signal the same errors as if called from Kernel.
+*/
+static inline klisp_CFunction prim_fn(TValue app)
+{
+    TValue op = kunwrap(app);
+    return ttisoperative(op)? tv2op(op)->fn : NULL;
+}
+
+/* pair?, null?, number?, odd?, etc */
+static inline bool prim_unary_predp(TValue app)
+{
+    klisp_CFunction fn = prim_fn(app);
+    return fn == typep || fn == ftypep || fn == ftyped_predp;
+}
+
+/* app should satisfy prim_unary_predp */
+static bool prim_unary_pred(klisp_State *K, TValue app, TValue obj)
+{
+    Operative *op = tv2op(kunwrap(app));
+    TValue *xparams = op->extra;
+
+    if (op->fn == typep) {
+        return ttype(obj) == ivalue(xparams[1]);
+    } else if (op->fn == ftypep) {
+        bool (*fn)(TValue obj) = pvalue(xparams[1]);
+        return (*fn)(obj);
+    } else { /* ftyped_predp */
+        bool (*typep)(TValue obj) = pvalue(xparams[1]);
+        bool (*predp)(TValue obj) = pvalue(xparams[2]);
+        if (!(*typep)(obj)) {
+            /* TODO show expected type */
+            klispE_throw_simple(K, "bad argument type");
+            return false;
+        }
+        return (*predp)(obj);
+    }
+}
+
+/* eq?, equal?, =?, char=?, string=?, etc */
+static inline bool prim_binary_predp(TValue app)
+{
+    klisp_CFunction fn = prim_fn(app);
+    return fn == eqp || fn == equalp || fn == ftyped_bpredp || 
+        fn == ftyped_kbpredp;
+}
+
+/* app should satisfy prim_binary_predp */
+static bool prim_binary_pred(klisp_State *K, TValue app, TValue obj1, 
+                             TValue obj2)
+{
+    Operative *op = tv2op(kunwrap(app));
+    TValue *xparams = op->extra;
+
+    if (op->fn == eqp) {
+        return eq2p(K, obj1, obj2);
+    } else if (op->fn == equalp) {
+        return equal2p(K, obj1, obj2);
+    } else {
+        bool (*typep)(TValue obj) = pvalue(xparams[1]);
+        if (!(*typep)(obj1) || !(*typep)(obj2)) {
+            /* TODO show expected type */
+            klispE_throw_simple(K, "bad argument type");
+            return false;
+        }
+        if (op->fn == ftyped_bpredp) {
+            bool (*predp)(TValue obj1, TValue obj2) = pvalue(xparams[2]);
+            return (*predp)(obj1, obj2);
+        } else { /* ftyped_kbpredp */
+            bool (*predp)(klisp_State *K, TValue obj1, TValue obj2) = 
+                pvalue(xparams[2]);
+            return (*predp)(K, obj1, obj2);
+        }
+    }
+}
+
+/* + & * */
+static inline bool prim_arithp(TValue app)
+{
+    klisp_CFunction fn = prim_fn(app);
+    return fn == kplus || fn == ktimes;
+}
+
+/* app should satisfy prim_arithp, the result is rooted in *res */
+static void prim_arith(klisp_State *K, TValue app, TValue *res, TValue obj)
+{
+    bool plusp = tv2op(kunwrap(app))->fn == kplus;
+    if (!knumberp(*res) || !knumberp(obj)) {
+        klispE_throw_simple(K, "bad operand type"); 
+        return;
+    }
+    *res = plusp? knum_plus(K, *res, obj) : knum_times(K, *res, obj);
+    if (ttisnwnpv(*res)) { /* #undefined or #real */
+        /* this will throw the no primary value error, 
+           same as (+ x y) or (* x y) would */
+        *res = plusp? knum_plus(K, *res, i2tv(0)) : 
+            knum_times(K, *res, i2tv(1));
+    }
+}
+
 /* 4.6.1 pair? */
 /* uses typep */
 
@@ -678,9 +789,34 @@ void filter(klisp_State *K)
       kapply_cc(K, KNIL);
     }
 
-    /* copy the list to ignore changes made by the applicative */
     int32_t pairs, cpairs;
     check_list(K, true, ls, &pairs, &cpairs);
+
+    if (prim_unary_predp(app)) {
+        /* no continuations needed, and the list can't be mutated */
+        int32_t apairs = pairs - cpairs;
+        int32_t acc_apairs = 0, acc_cpairs = 0;
+        TValue acc = KNIL;
+        krooted_vars_push(K, &acc);
+        TValue tail = ls;
+        for (int32_t i = 0; i < pairs; ++i) {
+            TValue first = kcar(tail);
+            if (prim_unary_pred(K, app, first)) {
+                acc = kcons(K, first, acc);
+                if (i < apairs)
+                    ++acc_apairs;
+                else
+                    ++acc_cpairs;
+            }
+            tail = kcdr(tail);
+        }
+        TValue res = reverse_copy_and_encycle(K, acc, acc_apairs + acc_cpairs,
+                                              acc_cpairs);
+        krooted_vars_pop(K);
+        kapply_cc(K, res);
+    }
+
+    /* copy the list to ignore changes made by the applicative */
     ls = check_copy_list(K, ls, false, &pairs, &cpairs);
     int apairs = pairs - cpairs;
 
@@ -758,7 +894,19 @@ void assoc(klisp_State *K)
     check_typed_list(K, kpairp, true, ls, &pairs, NULL);
 	
     TValue res;
-    if (predp) {
+    if (predp && prim_binary_predp(maybe_pred)) {
+        /* a primitive predicate, no continuation needed either */
+        TValue tail = ls;
+        res = KNIL;
+        while(pairs--) {
+            TValue first = kcar(tail);
+            if (prim_binary_pred(K, maybe_pred, obj, kcar(first))) {
+                res = first;
+                break;
+            }
+            tail = kcdr(tail);
+        }
+    } else if (predp) {
         /* we'll need use continuations, copy list first to
            avoid troubles with mutation */
         ls = check_copy_list(K, ls, false, NULL, NULL);
@@ -841,17 +989,29 @@ void memberp(klisp_State *K)
 
     bind_al2p(K, ptree, obj, ls, maybe_pred);
     bool predp = get_opt_tpar(K, maybe_pred, "applicative", ttisapplicative);
+    /* primitive predicates can be called directly */
+    bool primp = predp && prim_binary_predp(maybe_pred);
     
     /* first pass, check structure */
     int32_t pairs;
-    if (predp) { /* copy if a custom predicate is used */
+    if (predp && !primp) { /* copy if a custom predicate is used */
         ls = check_copy_list(K, ls, false, &pairs, NULL);
     } else { 
         check_list(K, true, ls, &pairs, NULL);
     }
 
     TValue res;
-    if (predp) {
+    if (primp) {
+        TValue tail = ls;
+        res = KFALSE;
+        while(pairs--) {
+            if (prim_binary_pred(K, maybe_pred, obj, kcar(tail))) {
+                res = KTRUE;
+                break;
+            }
+            tail = kcdr(tail);
+        }
+    } else if (predp) {
         /* we'll need use continuations */
         krooted_tvs_push(K, ls);
         TValue cont = kmake_continuation(K, kget_cc(K), do_memberp, 4,
@@ -1168,6 +1328,23 @@ void reduce(klisp_State *K)
 
     /* TODO all of these in one procedure */
     int32_t pairs, cpairs;
+
+    if (prim_arithp(bin)) {
+        check_list(K, true, ls, &pairs, &cpairs);
+        if (cpairs == 0) {
+            /* + or * on a finite list, fold it here */
+            TValue res = kcar(ls);
+            krooted_vars_push(K, &res);
+            TValue tail = kcdr(ls);
+            while(--pairs > 0) {
+                prim_arith(K, bin, &res, kcar(tail));
+                tail = kcdr(tail);
+            }
+            krooted_vars_pop(K);
+            kapply_cc(K, res);
+        }
+    }
+
     /* force copy to be able to do all precycles and replace
        the corresponding objs in ls */
     ls = check_copy_list(K, ls, true, &pairs, &cpairs);
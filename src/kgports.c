@@ -16,6 +16,7 @@
 #include "kstring.h"
 #include "ktable.h"
 #include "kbytevector.h"
+#include "kslice.h"
 #include "kenvironment.h"
 #include "kapplicative.h"
 #include "koperative.h"
@@ -27,6 +28,7 @@
 #include "kread.h"
 #include "kwrite.h"
 #include "kpair.h"
+#include "ksystem.h"
 
 #include "kghelpers.h"
 #include "kgports.h"
@@ -122,7 +124,7 @@ void get_current_port(klisp_State *K)
     check_0p(K, ptree);
 
     /* can access directly, no need to call do_access */
-    kapply_cc(K, kcdr(key));
+    kapply_cc(K, klispT_kd_value(K, key));
 }
 
 
@@ -172,10 +174,10 @@ void open_mport(klisp_State *K)
         check_0p(K, ptree);
         buffer = KINERT;
     } else if (binaryp) {
-        bind_1tp(K, ptree, "bytevector", ttisbytevector, bb);
+        bind_1tp(K, ptree, "bytevector", ttisbvview, bb);
         buffer = bb;
     } else {
-        bind_1tp(K, ptree, "string", ttisstring, str);
+        bind_1tp(K, ptree, "string", ttisstrview, str);
         buffer = str;
     }
 
@@ -185,6 +187,30 @@ void open_mport(klisp_State *K)
 
 /* 15.1.? open-output-string, open-output-bytevector */
 
+/* 15.1.? make-pipe, make-binary-pipe */
+/* 15.1.? make-socket-pair, make-binary-socket-pair */
+void make_pipe(klisp_State *K)
+{
+    TValue *xparams = K->next_xparams;
+    TValue ptree = K->next_value;
+    TValue denv = K->next_env;
+    klisp_assert(ttisenvironment(K->next_env));
+    UNUSED(denv);
+
+    /*
+    ** xparams[0]: socket?
+    ** xparams[1]: binary?
+    */
+    bool socketp = bvalue(xparams[0]);
+    bool binaryp = bvalue(xparams[1]);
+
+    check_0p(K, ptree);
+
+    TValue res = socketp? ksystem_make_socket_pair(K, binaryp) :
+        ksystem_make_pipe(K, binaryp);
+    kapply_cc(K, res);
+}
+
 /* 15.1.6 close-input-file, close-output-file */
 void close_file(klisp_State *K)
 {
@@ -274,18 +300,22 @@ void get_output_buffer(klisp_State *K)
 }
 
 /* 15.1.7 read */
+/* ?.? read-data */
 void gread(klisp_State *K)
 {
     TValue *xparams = K->next_xparams;
     TValue ptree = K->next_value;
     TValue denv = K->next_env;
     klisp_assert(ttisenvironment(K->next_env));
-    UNUSED(xparams);
+    /*
+    ** xparams[0]: save source info?
+    */
     UNUSED(denv);
+    bool sip = bvalue(xparams[0]);
     
     TValue port = ptree;
     if (!get_opt_tpar(K, port, "port", ttisport)) {
-        port = kcdr(G(K)->kd_in_port_key); /* access directly */
+        port = kcurr_input_port(K); /* access directly */
     } 
 
     if (!kport_is_input(port)) {
@@ -300,7 +330,9 @@ void gread(klisp_State *K)
     }
 
     /* this may throw an error, that's ok */
-    TValue obj = kread_from_port(K, port, true); /* read mutable pairs */ 
+    /* read mutable pairs */ 
+    TValue obj = sip? kread_from_port(K, port, true) : 
+        kread_data_from_port(K, port, true);
     kapply_cc(K, obj);
 }
 
@@ -318,7 +350,7 @@ void gwrite(klisp_State *K)
                port);
 
     if (!get_opt_tpar(K, port, "port", ttisport)) {
-        port = kcdr(G(K)->kd_out_port_key); /* access directly */
+        port = kcurr_output_port(K); /* access directly */
     } 
 
     if (!kport_is_output(port)) {
@@ -351,7 +383,7 @@ void gwrite_simple(klisp_State *K)
                port);
 
     if (!get_opt_tpar(K, port, "port", ttisport)) {
-        port = kcdr(G(K)->kd_out_port_key); /* access directly */
+        port = kcurr_output_port(K); /* access directly */
     } 
 
     if (!kport_is_output(port)) {
@@ -384,7 +416,7 @@ void newline(klisp_State *K)
     
     TValue port = ptree;
     if (!get_opt_tpar(K, port, "port", ttisport)) {
-        port = kcdr(G(K)->kd_out_port_key); /* access directly */
+        port = kcurr_output_port(K); /* access directly */
     }
 
     if (!kport_is_output(port)) {
@@ -416,7 +448,7 @@ void write_char(klisp_State *K)
                port);
 
     if (!get_opt_tpar(K, port, "port", ttisport)) {
-        port = kcdr(G(K)->kd_out_port_key); /* access directly */
+        port = kcurr_output_port(K); /* access directly */
     } 
 
     if (!kport_is_output(port)) {
@@ -450,7 +482,7 @@ void read_peek_char(klisp_State *K)
 
     TValue port = ptree;
     if (!get_opt_tpar(K, port, "port", ttisport)) {
-        port = kcdr(G(K)->kd_in_port_key); /* access directly */
+        port = kcurr_input_port(K); /* access directly */
     } 
     
     if (!kport_is_input(port)) {
@@ -476,10 +508,8 @@ void read_peek_char(klisp_State *K)
 /* uses read_peek_char */
 
 /* 15.1.? char-ready? */
-/* XXX: this always return #t, proper behaviour requires platform 
-   specific code (probably select for posix & a thread for windows
-   (at least for files & consoles, I think pipes and sockets may
-   have something) */
+/* file ports are checked with poll (see ksystem.posix.c), in platforms
+   where that isn't available this always returns #t */
 void char_readyp(klisp_State *K)
 {
     TValue *xparams = K->next_xparams;
@@ -491,7 +521,7 @@ void char_readyp(klisp_State *K)
     
     TValue port = ptree;
     if (!get_opt_tpar(K, port, "port", ttisport)) {
-        port = kcdr(G(K)->kd_in_port_key); /* access directly */
+        port = kcurr_input_port(K); /* access directly */
     } 
 
     if (!kport_is_input(port)) {
@@ -505,8 +535,7 @@ void char_readyp(klisp_State *K)
         return;
     }
 
-    /* TODO: check if there are pending chars */
-    kapply_cc(K, KTRUE);
+    kapply_cc(K, b2tv(ksystem_port_ready(K, port)));
 }
 
 /* 15.1.? write-u8 */
@@ -522,7 +551,7 @@ void write_u8(klisp_State *K)
     bind_al1tp(K, ptree, "u8", ttisu8, u8, port);
 
     if (!get_opt_tpar(K, port, "port", ttisport)) {
-        port = kcdr(G(K)->kd_out_port_key); /* access directly */
+        port = kcurr_output_port(K); /* access directly */
     } 
 
     if (!kport_is_output(port)) {
@@ -556,7 +585,7 @@ void read_peek_u8(klisp_State *K)
 
     TValue port = ptree;
     if (!get_opt_tpar(K, port, "port", ttisport)) {
-        port = kcdr(G(K)->kd_in_port_key); /* access directly */
+        port = kcurr_input_port(K); /* access directly */
     }
 
     if (!kport_is_input(port)) {
@@ -582,10 +611,8 @@ void read_peek_u8(klisp_State *K)
 /* uses read_peek_u8 */
 
 /* 15.1.? u8-ready? */
-/* XXX: this always return #t, proper behaviour requires platform 
-   specific code (probably select for posix & a thread for windows
-   (at least for files & consoles, I think pipes and sockets may
-   have something) */
+/* file ports are checked with poll (see ksystem.posix.c), in platforms
+   where that isn't available this always returns #t */
 void u8_readyp(klisp_State *K)
 {
     TValue *xparams = K->next_xparams;
@@ -597,7 +624,7 @@ void u8_readyp(klisp_State *K)
     
     TValue port = ptree;
     if (!get_opt_tpar(K, port, "port", ttisport)) {
-        port = kcdr(G(K)->kd_in_port_key); /* access directly */
+        port = kcurr_input_port(K); /* access directly */
     }
     
     if (!kport_is_input(port)) {
@@ -611,8 +638,47 @@ void u8_readyp(klisp_State *K)
         return;
     }
 
-    /* TODO: check if there are pending chars */
-    kapply_cc(K, KTRUE);
+    kapply_cc(K, b2tv(ksystem_port_ready(K, port)));
+}
+
+/* 15.1.? wait-for-ports */
+void wait_for_ports(klisp_State *K)
+{
+    TValue *xparams = K->next_xparams;
+    TValue ptree = K->next_value;
+    TValue denv = K->next_env;
+    klisp_assert(ttisenvironment(K->next_env));
+    UNUSED(xparams);
+    UNUSED(denv);
+
+    bind_al1p(K, ptree, ports, maybe_msecs);
+
+    int32_t pairs;
+    check_typed_list(K, kportp, false, ports, &pairs, NULL);
+
+    TValue tail = ports;
+    for (int32_t i = 0; i < pairs; ++i, tail = kcdr(tail)) {
+        if (kport_is_closed(kcar(tail))) {
+            klispE_throw_simple_with_irritants(K, "the port is already "
+                                               "closed", 1, kcar(tail));
+            return;
+        }
+    }
+
+    int32_t msecs = -1; /* no timeout */
+    if (get_opt_tpar(K, maybe_msecs, "fixint", ttisfixint)) {
+        if (ivalue(maybe_msecs) < 0) {
+            klispE_throw_simple_with_irritants(K, "negative timeout", 1,
+                                               maybe_msecs);
+            return;
+        }
+        msecs = ivalue(maybe_msecs);
+    } else if (pairs == 0) {
+        klispE_throw_simple(K, "no ports to wait for and no timeout");
+        return;
+    }
+
+    kapply_cc(K, ksystem_wait_ports(K, ports, pairs, msecs));
 }
 
 /* 15.2.1 call-with-input-file, call-with-output-file */
@@ -1130,7 +1196,7 @@ void display(klisp_State *K)
                port);
 
     if (!get_opt_tpar(K, port, "port", ttisport)) {
-        port = kcdr(G(K)->kd_out_port_key); /* access directly */
+        port = kcurr_output_port(K); /* access directly */
     }
 
     if (!kport_is_output(port)) {
@@ -1161,7 +1227,7 @@ void read_line(klisp_State *K)
     
     TValue port = ptree;
     if (!get_opt_tpar(K, port, "port", ttisport)) {
-        port = kcdr(G(K)->kd_in_port_key); /* access directly */
+        port = kcurr_input_port(K); /* access directly */
     }
 
     if (!kport_is_input(port)) {
@@ -1192,7 +1258,7 @@ void flush(klisp_State *K)
     TValue port = ptree;
 
     if (!get_opt_tpar(K, port, "port", ttisport)) {
-        port = kcdr(G(K)->kd_out_port_key); /* access directly */
+        port = kcurr_output_port(K); /* access directly */
     }
 
     if (!kport_is_output(port)) {
@@ -1279,6 +1345,16 @@ void kinit_ports_ground_env(klisp_State *K)
                     b2tv(false), b2tv(true));
     add_applicative(K, ground_env, "open-output-bytevector", open_mport, 2, 
                     b2tv(true), b2tv(true));
+    /* 15.1.? make-pipe, make-binary-pipe */
+    add_applicative(K, ground_env, "make-pipe", make_pipe, 2, 
+                    b2tv(false), b2tv(false));
+    add_applicative(K, ground_env, "make-binary-pipe", make_pipe, 2, 
+                    b2tv(false), b2tv(true));
+    /* 15.1.? make-socket-pair, make-binary-socket-pair */
+    add_applicative(K, ground_env, "make-socket-pair", make_pipe, 2, 
+                    b2tv(true), b2tv(false));
+    add_applicative(K, ground_env, "make-binary-socket-pair", make_pipe, 2, 
+                    b2tv(true), b2tv(true));
 
     /* 15.1.6 close-input-file, close-output-file */
     /* ASK John: should this be called close-input-port & close-ouput-port 
@@ -1303,7 +1379,9 @@ void kinit_ports_ground_env(klisp_State *K)
                     1, b2tv(true));
 
     /* 15.1.7 read */
-    add_applicative(K, ground_env, "read", gread, 0);
+    add_applicative(K, ground_env, "read", gread, 1, KTRUE);
+    /* ?.? read-data */
+    add_applicative(K, ground_env, "read-data", gread, 1, KFALSE);
     /* 15.1.8 write */
     add_applicative(K, ground_env, "write", gwrite, 0);
     /* 15.1.? write-simple */
@@ -1330,10 +1408,6 @@ void kinit_ports_ground_env(klisp_State *K)
     add_applicative(K, ground_env, "peek-char", read_peek_char, 1,
                     b2tv(true));
     /* 15.1.? char-ready? */
-    /* XXX: this always return #t, proper behaviour requires platform 
-       specific code (probably select for posix, a thread for windows
-       (at least for files & consoles), I think pipes and sockets may
-       have something */
     add_applicative(K, ground_env, "char-ready?", char_readyp, 0);
     /* 15.1.? write-u8 */
     add_applicative(K, ground_env, "write-u8", write_u8, 0);
@@ -1344,11 +1418,9 @@ void kinit_ports_ground_env(klisp_State *K)
     add_applicative(K, ground_env, "peek-u8", read_peek_u8, 1, 
                     b2tv(true));
     /* 15.1.? u8-ready? */
-    /* XXX: this always return #t, proper behaviour requires platform 
-       specific code (probably select for posix, a thread for windows
-       (at least for files & consoles), I think pipes and sockets may
-       have something */
     add_applicative(K, ground_env, "u8-ready?", u8_readyp, 0);
+    /* 15.1.? wait-for-ports */
+    add_applicative(K, ground_env, "wait-for-ports", wait_for_ports, 0);
     /* 15.2.1 call-with-input-file, call-with-output-file */
     add_applicative(K, ground_env, "call-with-input-file", call_with_file, 
                     2, symbol, b2tv(false));
@@ -78,6 +78,7 @@ void kinit_cont_names(klisp_State *K)
     kinit_control_cont_names(K);
     kinit_promises_cont_names(K);
     kinit_ports_cont_names(K);
+    kinit_threads_cont_names(K);
 #if KUSE_LIBFFI
     kinit_ffi_cont_names(K);
 #endif
@@ -23,6 +23,8 @@
 #include "kstring.h"
 #include "kvector.h"
 #include "kbytevector.h"
+#include "kstrbuilder.h"
+#include "kslice.h"
 
 #include "kghelpers.h"
 #include "kgstrings.h"
@@ -70,9 +72,9 @@ void string_length(klisp_State *K)
     klisp_assert(ttisenvironment(K->next_env));
     UNUSED(xparams);
     UNUSED(denv);
-    bind_1tp(K, ptree, "string", ttisstring, str);
+    bind_1tp(K, ptree, "string", ttisstrview, str);
 
-    TValue res = i2tv(kstring_size(str));
+    TValue res = i2tv(kstrview_size(str));
     kapply_cc(K, res);
 }
 
@@ -85,7 +87,7 @@ void string_ref(klisp_State *K)
     klisp_assert(ttisenvironment(K->next_env));
     UNUSED(xparams);
     UNUSED(denv);
-    bind_2tp(K, ptree, "string", ttisstring, str,
+    bind_2tp(K, ptree, "string", ttisstrview, str,
              "exact integer", keintegerp, tv_i);
 
     if (!ttisfixint(tv_i)) {
@@ -95,13 +97,13 @@ void string_ref(klisp_State *K)
     }
     int32_t i = ivalue(tv_i);
     
-    if (i < 0 || i >= kstring_size(str)) {
+    if (i < 0 || i >= kstrview_size(str)) {
         /* TODO show index */
         klispE_throw_simple(K, "index out of bounds");
         return;
     }
 
-    TValue res = ch2tv(kstring_buf(str)[i]);
+    TValue res = ch2tv(kstrview_buf(str)[i]);
     kapply_cc(K, res);
 }
 
@@ -167,10 +169,10 @@ void kstring_change_case(klisp_State *K)
     ** xparams[0]: conversion fn
     */
     UNUSED(denv);
-    bind_1tp(K, ptree, "string", ttisstring, str);
+    bind_1tp(K, ptree, "string", ttisstrview, str);
     char (*fn)(char) = pvalue(xparams[0]);
-    int32_t size = kstring_size(str);
-    TValue res = kstring_new_bs(K, kstring_buf(str), size);
+    int32_t size = kstrview_size(str);
+    TValue res = kstring_new_bs(K, kstrview_buf(str), size);
     char *buf = kstring_buf(res);
     for(int32_t i = 0; i < size; ++i, buf++) {
         *buf = fn(*buf);
@@ -186,9 +188,9 @@ void kstring_title_case(klisp_State *K)
     klisp_assert(ttisenvironment(K->next_env));
     UNUSED(xparams);
     UNUSED(denv);
-    bind_1tp(K, ptree, "string", ttisstring, str);
-    uint32_t size = kstring_size(str);
-    TValue res = kstring_new_bs(K, kstring_buf(str), size);
+    bind_1tp(K, ptree, "string", ttisstrview, str);
+    uint32_t size = kstrview_size(str);
+    TValue res = kstring_new_bs(K, kstrview_buf(str), size);
     char *buf = kstring_buf(res);
     bool first = true;
     while(size-- > 0) {
@@ -219,21 +221,44 @@ void kstring_title_case(klisp_State *K)
 /* Helpers for binary predicates */
 /* XXX: this should probably be in file kstring.h */
 
+/* 
+** Case folding table for the ci predicates and the searches, this
+** avoids a call to tolower for every char (ASCII only for now) 
+*/
+#define FOLD1(c_) ((c_) >= 'A' && (c_) <= 'Z'? (c_) - 'A' + 'a' : (c_))
+#define FOLD4(c_) FOLD1(c_), FOLD1((c_)+1), FOLD1((c_)+2), FOLD1((c_)+3)
+#define FOLD16(c_) FOLD4(c_), FOLD4((c_)+4), FOLD4((c_)+8), FOLD4((c_)+12)
+#define FOLD64(c_) FOLD16(c_), FOLD16((c_)+16), FOLD16((c_)+32),     \
+        FOLD16((c_)+48)
+
+static const uint8_t fold_table[256] = { 
+    FOLD64(0), FOLD64(64), FOLD64(128), FOLD64(192) 
+};
+
+#define kfold(ch_) (fold_table[(uint8_t) (ch_)])
+
 bool kstring_eqp(TValue str1, TValue str2) { 
-    return tv_equal(str1, str2) || kstring_equalp(str1, str2);
+    if (tv_equal(str1, str2))
+        return true;
+    else if (ttisstring(str1) && ttisstring(str2))
+        return kstring_equalp(str1, str2);
+
+    int32_t size = kstrview_size(str1);
+    return kstrview_size(str2) == size &&
+        memcmp(kstrview_buf(str1), kstrview_buf(str2), size) == 0;
 }
 
 bool kstring_ci_eqp(TValue str1, TValue str2)
 {
-    int32_t size = kstring_size(str1);
-    if (kstring_size(str2) != size)
+    int32_t size = kstrview_size(str1);
+    if (kstrview_size(str2) != size)
         return false;
     else {
-        char *buf1 = kstring_buf(str1);
-        char *buf2 = kstring_buf(str2);
+        char *buf1 = kstrview_buf(str1);
+        char *buf2 = kstrview_buf(str2);
 
         while(size--) {
-            if (tolower(*buf1) != tolower(*buf2))
+            if (kfold(*buf1) != kfold(*buf2))
                 return false;
             buf1++, buf2++;
         }
@@ -243,12 +268,12 @@ bool kstring_ci_eqp(TValue str1, TValue str2)
 
 bool kstring_ltp(TValue str1, TValue str2)
 {
-    int32_t size1 = kstring_size(str1);
-    int32_t size2 = kstring_size(str2);
+    int32_t size1 = kstrview_size(str1);
+    int32_t size2 = kstrview_size(str2);
 
     int32_t min_size = size1 < size2? size1 : size2;
     /* memcmp > 0 if str1 has a bigger char in first diff position */
-    int res = memcmp(kstring_buf(str1), kstring_buf(str2), min_size);
+    int res = memcmp(kstrview_buf(str1), kstrview_buf(str2), min_size);
 
     return (res < 0 || (res == 0 && size1 < size2));
 }
@@ -259,14 +284,14 @@ bool kstring_gep(TValue str1, TValue str2) { return !kstring_ltp(str1, str2); }
 
 bool kstring_ci_ltp(TValue str1, TValue str2)
 {
-    int32_t size1 = kstring_size(str1);
-    int32_t size2 = kstring_size(str2);
+    int32_t size1 = kstrview_size(str1);
+    int32_t size2 = kstrview_size(str2);
     int32_t min_size = size1 < size2? size1 : size2;
-    char *buf1 = kstring_buf(str1);
-    char *buf2 = kstring_buf(str2);
+    char *buf1 = kstrview_buf(str1);
+    char *buf2 = kstrview_buf(str2);
 
     while(min_size--) {
-        int diff = (int) tolower(*buf1) - (int) tolower(*buf2);
+        int diff = (int) kfold(*buf1) - (int) kfold(*buf2);
         if (diff > 0)
             return false;
         else if (diff < 0)
@@ -295,20 +320,25 @@ bool kstring_ci_gep(TValue str1, TValue str2)
 /* TEMP: at least for now this always returns mutable strings (like in Racket and
    following the Kernel Report where it says that object returned should be mutable 
    unless stated) */
+/* 13.?? string-slice */
+/* this returns a slice sharing the chars of str instead */
 void substring(klisp_State *K)
 {
     TValue *xparams = K->next_xparams;
     TValue ptree = K->next_value;
     TValue denv = K->next_env;
     klisp_assert(ttisenvironment(K->next_env));
-    UNUSED(xparams);
+    /*
+    ** xparams[0]: slice?
+    */
+    bool slicep = bvalue(xparams[0]);
     UNUSED(denv);
-    bind_3tp(K, ptree, "string", ttisstring, str,
+    bind_3tp(K, ptree, "string", ttisstrview, str,
              "exact integer", keintegerp, tv_start,
              "exact integer", keintegerp, tv_end);
 
     if (!ttisfixint(tv_start) || ivalue(tv_start) < 0 ||
-        ivalue(tv_start) > kstring_size(str)) {
+        ivalue(tv_start) > kstrview_size(str)) {
         /* TODO show index */
         klispE_throw_simple(K, "start index out of bounds");
         return;
@@ -317,7 +347,7 @@ void substring(klisp_State *K)
     int32_t start = ivalue(tv_start);
 
     if (!ttisfixint(tv_end) || ivalue(tv_end) < 0 || 
-        ivalue(tv_end) > kstring_size(str)) {
+        ivalue(tv_end) > kstrview_size(str)) {
         klispE_throw_simple(K, "end index out of bounds");
         return;
     }
@@ -333,11 +363,14 @@ void substring(klisp_State *K)
     int32_t size = end - start;
     TValue new_str;
     /* the if isn't strictly necessary but it's clearer this way */
-    if (size == 0) {
+    if (slicep) {
+        /* str is rooted in ptree */
+        new_str = kmake_slice(K, str, start, size);
+    } else if (size == 0) {
         new_str = G(K)->empty_string;
     } else {
         /* always returns mutable strings */
-        new_str = kstring_new_bs(K, kstring_buf(str)+start, size);
+        new_str = kstring_new_bs(K, kstrview_buf(str)+start, size);
     }
     kapply_cc(K, new_str);
 }
@@ -355,7 +388,7 @@ void string_append(klisp_State *K)
     UNUSED(denv);
     /* don't allow cycles */
     int32_t pairs;
-    check_typed_list(K, kstringp, false, ptree, &pairs, NULL);
+    check_typed_list(K, kstrviewp, false, ptree, &pairs, NULL);
 
     TValue new_str;
     int64_t total_size = 0; /* use int64 to check for overflow */
@@ -363,7 +396,7 @@ void string_append(klisp_State *K)
     int32_t saved_pairs = pairs; /* save pairs for next loop */
     TValue tail = ptree;
     while(pairs--) {
-        total_size += kstring_size(kcar(tail));
+        total_size += kstrview_size(kcar(tail));
         if (total_size > INT32_MAX) {
             klispE_throw_simple(K, "resulting string is too big");
             return;
@@ -384,8 +417,8 @@ void string_append(klisp_State *K)
 
         while(pairs--) {
             TValue first = kcar(tail);
-            int32_t first_size = kstring_size(first);
-            memcpy(buf, kstring_buf(first), first_size);
+            int32_t first_size = kstrview_size(first);
+            memcpy(buf, kstrview_buf(first), first_size);
             buf += first_size;
             tail = kcdr(tail);
         }
@@ -405,7 +438,7 @@ void string_to_list(klisp_State *K)
     UNUSED(xparams);
     UNUSED(denv);
     
-    bind_1tp(K, ptree, "string", ttisstring, str);
+    bind_1tp(K, ptree, "string", ttisstrview, str);
     TValue res = string_to_list_h(K, str, NULL);
     kapply_cc(K, res);
 }
@@ -438,18 +471,18 @@ void string_to_vector(klisp_State *K)
     UNUSED(xparams);
     UNUSED(denv);
     
-    bind_1tp(K, ptree, "string", ttisstring, str);
+    bind_1tp(K, ptree, "string", ttisstrview, str);
     TValue res;
 
-    if (kstring_emptyp(str)) {
+    if (kstrview_size(str) == 0) {
         res = G(K)->empty_vector;
     } else {
-        uint32_t size = kstring_size(str);
+        uint32_t size = kstrview_size(str);
 
         /* MAYBE add vector constructor without fill */
         /* no need to root this */
         res = kvector_new_sf(K, size, KINERT);
-        char *src = kstring_buf(str);
+        char *src = kstrview_buf(str);
         TValue *dst = kvector_buf(res);
         while(size--) {
             char ch = *src++; /* not needed but just in case */
@@ -503,18 +536,18 @@ void string_to_bytevector(klisp_State *K)
     UNUSED(xparams);
     UNUSED(denv);
     
-    bind_1tp(K, ptree, "string", ttisstring, str);
+    bind_1tp(K, ptree, "string", ttisstrview, str);
     TValue res;
 
-    if (kstring_emptyp(str)) {
+    if (kstrview_size(str) == 0) {
         res = G(K)->empty_bytevector;
     } else {
-        uint32_t size = kstring_size(str);
+        uint32_t size = kstrview_size(str);
 
         /* MAYBE add bytevector constructor without fill */
         /* no need to root this */
         res = kbytevector_new_s(K, size);
-        char *src = kstring_buf(str);
+        char *src = kstrview_buf(str);
         uint8_t *dst = kbytevector_buf(res);
 	
         while(size--) {
@@ -534,15 +567,15 @@ void bytevector_to_string(klisp_State *K)
     UNUSED(xparams);
     UNUSED(denv);
     
-    bind_1tp(K, ptree, "bytevector", ttisbytevector, bb);
+    bind_1tp(K, ptree, "bytevector", ttisbvview, bb);
     TValue res;
 
-    if (kbytevector_emptyp(bb)) {
+    if (kbvview_size(bb) == 0) {
         res = G(K)->empty_string;
     } else {
-        uint32_t size = kbytevector_size(bb);
+        uint32_t size = kbvview_size(bb);
         res = kstring_new_s(K, size); /* no need to root this */
-        uint8_t *src = kbytevector_buf(bb);
+        uint8_t *src = kbvview_buf(bb);
         char *dst = kstring_buf(res);
         while(size--) {
             uint8_t u8 = *src++;
@@ -567,14 +600,14 @@ void string_copy(klisp_State *K)
     klisp_assert(ttisenvironment(K->next_env));
     UNUSED(xparams);
     UNUSED(denv);
-    bind_1tp(K, ptree, "string", ttisstring, str);
+    bind_1tp(K, ptree, "string", ttisstrview, str);
 
     TValue new_str;
     /* the if isn't strictly necessary but it's clearer this way */
     if (tv_equal(str, G(K)->empty_string)) {
         new_str = str; 
     } else {
-        new_str = kstring_new_bs(K, kstring_buf(str), kstring_size(str));
+        new_str = kstring_new_bs(K, kstrview_buf(str), kstrview_size(str));
     }
     kapply_cc(K, new_str);
 }
@@ -588,13 +621,14 @@ void string_to_immutable_string(klisp_State *K)
     klisp_assert(ttisenvironment(K->next_env));
     UNUSED(xparams);
     UNUSED(denv);
-    bind_1tp(K, ptree, "string", ttisstring, str);
+    bind_1tp(K, ptree, "string", ttisstrview, str);
 
     TValue res_str;
-    if (kstring_immutablep(str)) {/* this includes the empty list */
+    if (ttisstring(str) && kstring_immutablep(str)) {/* this includes the empty list */
         res_str = str;
     } else {
-        res_str = kstring_new_bs_imm(K, kstring_buf(str), kstring_size(str));
+        res_str = kstring_new_bs_imm(K, kstrview_buf(str), 
+                                     kstrview_size(str));
     }
     kapply_cc(K, res_str);
 }
@@ -620,6 +654,307 @@ void string_fillB(klisp_State *K)
     kapply_cc(K, KINERT);
 }
 
+/* Helper for string-index and string-search, gets the optional start
+   index (default 0), which should be a valid index or the size */
+static bool get_start_index(klisp_State *K, TValue maybe_start, 
+                            int32_t size, int32_t *start)
+{
+    *start = 0;
+    if (ttisnil(maybe_start))
+        return true;
+    else if (!ttispair(maybe_start) || !ttisnil(kcdr(maybe_start))) {
+        klispE_throw_simple(K, "Bad ptree structure (in optional argument)");
+        return false;
+    }
+    TValue tv_start = kcar(maybe_start);
+    if (!keintegerp(tv_start)) {
+        klispE_throw_simple(K, "Bad type on optional argument (expected "
+                            "exact integer)");
+        return false;
+    } else if (!ttisfixint(tv_start) || ivalue(tv_start) < 0 ||
+               ivalue(tv_start) > size) {
+        /* TODO show index */
+        klispE_throw_simple(K, "start index out of bounds");
+        return false;
+    }
+    *start = ivalue(tv_start);
+    return true;
+}
+
+/* Returns the index of the first occurrence of pat in buf or -1.
+   memchr looks for the first char of pat (it is usually much faster 
+   than a loop in C) and only the candidates are compared */
+static int32_t search_buf(const char *buf, int32_t size, 
+                          const char *pat, int32_t pat_size)
+{
+    if (pat_size == 0)
+        return 0;
+    else if (pat_size > size)
+        return -1;
+
+    const char *p = buf;
+    /* last position where pat could start */
+    const char *last = buf + (size - pat_size);
+    char first = pat[0];
+
+    while(p <= last) {
+        p = memchr(p, first, last - p + 1);
+        if (p == NULL)
+            return -1;
+        if (memcmp(p + 1, pat + 1, pat_size - 1) == 0)
+            return (int32_t) (p - buf);
+        ++p;
+    }
+    return -1;
+}
+
+/* 13.?? string-index */
+void string_index(klisp_State *K)
+{
+    TValue *xparams = K->next_xparams;
+    TValue ptree = K->next_value;
+    TValue denv = K->next_env;
+    klisp_assert(ttisenvironment(K->next_env));
+    UNUSED(xparams);
+    UNUSED(denv);
+    bind_al2tp(K, ptree, "string", ttisstrview, str, "char", ttischar, tv_ch,
+               maybe_start);
+
+    int32_t size = kstrview_size(str);
+    int32_t start;
+    if (!get_start_index(K, maybe_start, size, &start))
+        return;
+
+    char *buf = kstrview_buf(str);
+    char *p = memchr(buf + start, chvalue(tv_ch), size - start);
+    TValue res = p == NULL? KFALSE : i2tv((int32_t) (p - buf));
+    kapply_cc(K, res);
+}
+
+/* 13.?? string-search */
+void string_search(klisp_State *K)
+{
+    TValue *xparams = K->next_xparams;
+    TValue ptree = K->next_value;
+    TValue denv = K->next_env;
+    klisp_assert(ttisenvironment(K->next_env));
+    UNUSED(xparams);
+    UNUSED(denv);
+    bind_al2tp(K, ptree, "string", ttisstrview, pat, "string", ttisstrview, 
+               str, maybe_start);
+
+    int32_t size = kstrview_size(str);
+    int32_t start;
+    if (!get_start_index(K, maybe_start, size, &start))
+        return;
+
+    int32_t i = search_buf(kstrview_buf(str) + start, size - start,
+                           kstrview_buf(pat), kstrview_size(pat));
+    TValue res = i < 0? KFALSE : i2tv(i + start);
+    kapply_cc(K, res);
+}
+
+static bool kchar_or_strviewp(TValue obj) 
+{ 
+    return ttischar(obj) || ttisstrview(obj); 
+}
+
+/* 13.?? string-split */
+/* the delimiters can be a char or a string (or slice) with all the 
+   delimiter chars, adjacent delimiters delimit empty strings */
+void string_split(klisp_State *K)
+{
+    TValue *xparams = K->next_xparams;
+    TValue ptree = K->next_value;
+    TValue denv = K->next_env;
+    klisp_assert(ttisenvironment(K->next_env));
+    UNUSED(xparams);
+    UNUSED(denv);
+    bind_2tp(K, ptree, "string", ttisstrview, str, "char or string", 
+             kchar_or_strviewp, delims);
+
+    /* the char set is a table, to test each char in constant time */
+    bool delim_set[256] = { false };
+    if (ttischar(delims)) {
+        delim_set[(uint8_t) chvalue(delims)] = true;
+    } else {
+        char *dbuf = kstrview_buf(delims);
+        for (int32_t i = 0, dsize = kstrview_size(delims); i < dsize; ++i)
+            delim_set[(uint8_t) dbuf[i]] = true;
+    }
+
+    TValue dummy = kcons(K, KNIL, KNIL);
+    krooted_vars_push(K, &dummy);
+    TValue last = dummy;
+
+    /* str is rooted in ptree and buffers aren't moved, so this is
+       valid across allocations */
+    char *buf = kstrview_buf(str);
+    int32_t size = kstrview_size(str);
+    int32_t start = 0;
+    for (int32_t i = 0; i <= size; ++i) {
+        if (i == size || delim_set[(uint8_t) buf[i]]) {
+            TValue new_str = kstring_new_bs(K, buf + start, i - start);
+            krooted_tvs_push(K, new_str);
+            TValue new_pair = kcons(K, new_str, KNIL);
+            krooted_tvs_pop(K);
+            kset_cdr(last, new_pair);
+            last = new_pair;
+            start = i + 1;
+        }
+    }
+
+    krooted_vars_pop(K);
+    kapply_cc(K, kcdr(dummy));
+}
+
+/* 13.?? string-join */
+void string_join(klisp_State *K)
+{
+    TValue *xparams = K->next_xparams;
+    TValue ptree = K->next_value;
+    TValue denv = K->next_env;
+    klisp_assert(ttisenvironment(K->next_env));
+    UNUSED(xparams);
+    UNUSED(denv);
+    bind_al1p(K, ptree, strs, maybe_sep);
+
+    TValue sep = maybe_sep;
+    if (!get_opt_tpar(K, sep, "string", ttisstrview))
+        sep = G(K)->empty_string;
+
+    /* don't allow cycles */
+    int32_t pairs;
+    check_typed_list(K, kstrviewp, false, strs, &pairs, NULL);
+
+    int64_t total_size = pairs > 0? 
+        (int64_t) (pairs - 1) * kstrview_size(sep) : 0; 
+    TValue tail = strs;
+    for (int32_t i = 0; i < pairs; ++i, tail = kcdr(tail)) {
+        total_size += kstrview_size(kcar(tail));
+        if (total_size > INT32_MAX) {
+            klispE_throw_simple(K, "resulting string is too big");
+            return;
+        }
+    }
+
+    TValue new_str = kstring_new_s(K, (uint32_t) total_size);
+    if (total_size > 0) {
+        char *buf = kstring_buf(new_str);
+        char *sep_buf = kstrview_buf(sep);
+        int32_t sep_size = kstrview_size(sep);
+        tail = strs;
+        for (int32_t i = 0; i < pairs; ++i, tail = kcdr(tail)) {
+            TValue first = kcar(tail);
+            int32_t first_size = kstrview_size(first);
+            if (i > 0) {
+                memcpy(buf, sep_buf, sep_size);
+                buf += sep_size;
+            }
+            memcpy(buf, kstrview_buf(first), first_size);
+            buf += first_size;
+        }
+    }
+    kapply_cc(K, new_str);
+}
+
+/* 13.?? string-builder? */
+/* uses typep */
+
+/* 13.?? make-string-builder */
+void make_string_builder(klisp_State *K)
+{
+    TValue *xparams = K->next_xparams;
+    TValue ptree = K->next_value;
+    TValue denv = K->next_env;
+    klisp_assert(ttisenvironment(K->next_env));
+    UNUSED(xparams);
+    UNUSED(denv);
+    TValue maybe_cap = ptree;
+
+    int32_t cap = 0;
+    if (get_opt_tpar(K, maybe_cap, "fixint", ttisfixint)) {
+        cap = ivalue(maybe_cap);
+        if (cap < 0) {
+            klispE_throw_simple(K, "negative capacity");
+            return;
+        }
+    }
+    TValue res = kmake_strbuilder(K, (uint32_t) cap);
+    kapply_cc(K, res);
+}
+
+/* 13.?? string-builder-append! */
+void string_builder_appendB(klisp_State *K)
+{
+    TValue *xparams = K->next_xparams;
+    TValue ptree = K->next_value;
+    TValue denv = K->next_env;
+    klisp_assert(ttisenvironment(K->next_env));
+    UNUSED(xparams);
+    UNUSED(denv);
+    bind_al1tp(K, ptree, "string builder", ttisstrbuilder, sb, objs);
+    
+    /* don't allow cycles */
+    int32_t pairs;
+    check_list(K, false, objs, &pairs, NULL);
+
+    /* first check all types, so that nothing is appended on error */
+    TValue tail = objs;
+    for (int32_t i = 0; i < pairs; ++i, tail = kcdr(tail)) {
+        TValue obj = kcar(tail);
+        if (!ttisstrview(obj) && !ttischar(obj)) {
+            klispE_throw_simple_with_irritants(K, "Bad type (expected string "
+                                               "or char)", 1, obj);
+            return;
+        }
+    }
+
+    /* sb & the strings are rooted in ptree */
+    tail = objs;
+    for (int32_t i = 0; i < pairs; ++i, tail = kcdr(tail)) {
+        TValue obj = kcar(tail);
+        if (ttischar(obj)) {
+            char ch = chvalue(obj);
+            kstrbuilder_append(K, sb, &ch, 1);
+        } else {
+            kstrbuilder_append(K, sb, kstrview_buf(obj), 
+                               kstrview_size(obj));
+        }
+    }
+    kapply_cc(K, KINERT);
+}
+
+/* 13.?? string-builder-length */
+void string_builder_length(klisp_State *K)
+{
+    TValue *xparams = K->next_xparams;
+    TValue ptree = K->next_value;
+    TValue denv = K->next_env;
+    klisp_assert(ttisenvironment(K->next_env));
+    UNUSED(xparams);
+    UNUSED(denv);
+    bind_1tp(K, ptree, "string builder", ttisstrbuilder, sb);
+
+    kapply_cc(K, i2tv(kstrbuilder_size(sb)));
+}
+
+/* 13.?? string-builder->string */
+void string_builder_to_string(klisp_State *K)
+{
+    TValue *xparams = K->next_xparams;
+    TValue ptree = K->next_value;
+    TValue denv = K->next_env;
+    klisp_assert(ttisenvironment(K->next_env));
+    UNUSED(xparams);
+    UNUSED(denv);
+    bind_1tp(K, ptree, "string builder", ttisstrbuilder, sb);
+
+    /* sb is rooted in ptree */
+    TValue res = kstrbuilder_to_string(K, sb);
+    kapply_cc(K, res);
+}
+
 /* init ground */
 void kinit_strings_ground_env(klisp_State *K)
 {
@@ -662,29 +997,29 @@ void kinit_strings_ground_env(klisp_State *K)
                     p2tv(tolower));
     /* 13.2.2? string=?, string-ci=? */
     add_applicative(K, ground_env, "string=?", ftyped_bpredp, 3,
-                    symbol, p2tv(kstringp), p2tv(kstring_eqp));
+                    symbol, p2tv(kstrviewp), p2tv(kstring_eqp));
     add_applicative(K, ground_env, "string-ci=?", ftyped_bpredp, 3,
-                    symbol, p2tv(kstringp), p2tv(kstring_ci_eqp));
+                    symbol, p2tv(kstrviewp), p2tv(kstring_ci_eqp));
     /* 13.2.3? string<?, string<=?, string>?, string>=? */
     add_applicative(K, ground_env, "string<?", ftyped_bpredp, 3,
-                    symbol, p2tv(kstringp), p2tv(kstring_ltp));
+                    symbol, p2tv(kstrviewp), p2tv(kstring_ltp));
     add_applicative(K, ground_env, "string<=?", ftyped_bpredp, 3,
-                    symbol, p2tv(kstringp), p2tv(kstring_lep));
+                    symbol, p2tv(kstrviewp), p2tv(kstring_lep));
     add_applicative(K, ground_env, "string>?", ftyped_bpredp, 3,
-                    symbol, p2tv(kstringp), p2tv(kstring_gtp));
+                    symbol, p2tv(kstrviewp), p2tv(kstring_gtp));
     add_applicative(K, ground_env, "string>=?", ftyped_bpredp, 3,
-                    symbol, p2tv(kstringp), p2tv(kstring_gep));
+                    symbol, p2tv(kstrviewp), p2tv(kstring_gep));
     /* 13.2.4? string-ci<?, string-ci<=?, string-ci>?, string-ci>=? */
     add_applicative(K, ground_env, "string-ci<?", ftyped_bpredp, 3,
-                    symbol, p2tv(kstringp), p2tv(kstring_ci_ltp));
+                    symbol, p2tv(kstrviewp), p2tv(kstring_ci_ltp));
     add_applicative(K, ground_env, "string-ci<=?", ftyped_bpredp, 3,
-                    symbol, p2tv(kstringp), p2tv(kstring_ci_lep));
+                    symbol, p2tv(kstrviewp), p2tv(kstring_ci_lep));
     add_applicative(K, ground_env, "string-ci>?", ftyped_bpredp, 3,
-                    symbol, p2tv(kstringp), p2tv(kstring_ci_gtp));
+                    symbol, p2tv(kstrviewp), p2tv(kstring_ci_gtp));
     add_applicative(K, ground_env, "string-ci>=?", ftyped_bpredp, 3,
-                    symbol, p2tv(kstringp), p2tv(kstring_ci_gep));
+                    symbol, p2tv(kstrviewp), p2tv(kstring_ci_gep));
     /* 13.2.5? substring */
-    add_applicative(K, ground_env, "substring", substring, 0);
+    add_applicative(K, ground_env, "substring", substring, 1, KFALSE);
     /* 13.2.6? string-append */
     add_applicative(K, ground_env, "string-append", string_append, 0);
     /* 13.2.7? string->list, list->string */
@@ -706,4 +1041,28 @@ void kinit_strings_ground_env(klisp_State *K)
 
     /* 13.2.10? string-fill! */
     add_applicative(K, ground_env, "string-fill!", string_fillB, 0);
+
+    /* 13.?? string-index, string-search, string-split, string-join */
+    add_applicative(K, ground_env, "string-index", string_index, 0);
+    add_applicative(K, ground_env, "string-search", string_search, 0);
+    add_applicative(K, ground_env, "string-split", string_split, 0);
+    add_applicative(K, ground_env, "string-join", string_join, 0);
+
+    /* 13.?? string-slice?, string-slice */
+    add_applicative(K, ground_env, "string-slice?", ftypep, 2, symbol, 
+                    p2tv(kstring_slicep));
+    add_applicative(K, ground_env, "string-slice", substring, 1, KTRUE);
+
+    /* 13.?? string-builder?, make-string-builder, string-builder-append!,
+       string-builder-length, string-builder->string */
+    add_applicative(K, ground_env, "string-builder?", typep, 2, symbol, 
+                    i2tv(K_TSTRBUILDER));
+    add_applicative(K, ground_env, "make-string-builder", 
+                    make_string_builder, 0);
+    add_applicative(K, ground_env, "string-builder-append!", 
+                    string_builder_appendB, 0);
+    add_applicative(K, ground_env, "string-builder-length", 
+                    string_builder_length, 0);
+    add_applicative(K, ground_env, "string-builder->string", 
+                    string_builder_to_string, 0);
 }
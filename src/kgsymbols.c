@@ -17,6 +17,7 @@
 #include "kpair.h"
 #include "kstring.h"
 #include "ksymbol.h"
+#include "kslice.h"
 #include "kerror.h"
 
 #include "kghelpers.h"
@@ -49,10 +50,12 @@ void string_to_symbol(klisp_State *K)
     klisp_assert(ttisenvironment(K->next_env));
     UNUSED(xparams);
     UNUSED(denv);
-    bind_1tp(K, ptree, "string", ttisstring, str);
+    bind_1tp(K, ptree, "string", ttisstrview, str);
     /* TODO si */
     /* If the string is mutable it is copied */
-    TValue new_sym = ksymbol_new_str(K, str, KNIL);
+    /* slices are interned directly from the chars of the parent */
+    TValue new_sym = ttisstring(str)? ksymbol_new_str(K, str, KNIL) :
+        ksymbol_new_bs(K, kstrview_buf(str), kstrview_size(str), KNIL);
     kapply_cc(K, new_sym);
 }
 
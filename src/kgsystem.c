@@ -18,6 +18,12 @@
 #include "ksystem.h"
 #include "kinteger.h"
 #include "kgc.h"
+#include "ksymbol.h"
+#include "kstring.h"
+#include "ktable.h"
+#include "kport.h"
+#include "kwrite.h"
+#include "kprofile.h"
 
 #include "kghelpers.h"
 #include "kgsystem.h"
@@ -266,6 +272,230 @@ TValue create_env_var_list(klisp_State *K)
     return tail;
 }
 
+/*
+** Memory & GC statistics (these are klisp extensions)
+*/
+
+/* ?.? collect-garbage */
+void collect_garbage(klisp_State *K)
+{
+    TValue ptree = K->next_value;
+    check_0p(K, ptree);
+    klispC_fullgc(K);
+    kapply_cc(K, KINERT);
+}
+
+/* GC: assumes ls is rooted */
+static TValue add_statistic(klisp_State *K, TValue ls, const char *name, 
+                            uint64_t n)
+{
+    TValue value = kinteger_new_uint64(K, n);
+    krooted_tvs_push(K, value);
+    TValue sym = ksymbol_new_b(K, name, KNIL);
+    krooted_tvs_push(K, sym);
+    TValue entry = kcons(K, sym, value);
+    krooted_tvs_pop(K);
+    krooted_tvs_pop(K);
+    krooted_tvs_push(K, entry);
+    ls = kcons(K, entry, ls);
+    krooted_tvs_pop(K);
+    return ls;
+}
+
+/* ?.? gc-statistics */
+void gc_statistics(klisp_State *K)
+{
+    TValue ptree = K->next_value;
+    check_0p(K, ptree);
+    global_State *g = G(K);
+    /* take a snapshot first, building the list allocates */
+    uint64_t stats[] = { g->gccount, g->gctime, g->gcmaxpause, g->allocbytes,
+                         g->totalbytes, g->GCthreshold };
+    const char *names[] = { "collections", "total-pause", "max-pause", 
+                            "bytes-allocated", "heap-bytes", "gc-threshold" };
+
+    TValue res = KNIL;
+    krooted_vars_push(K, &res);
+    for (int32_t i = sizeof(stats) / sizeof(stats[0]) - 1; i >= 0; i--)
+        res = add_statistic(K, res, names[i], stats[i]);
+    krooted_vars_pop(K);
+    kapply_cc(K, res);
+}
+
+/* ?.? heap-statistics */
+void heap_statistics(klisp_State *K)
+{
+    TValue ptree = K->next_value;
+    check_0p(K, ptree);
+    /* collect first, to count only live objects */
+    klispC_fullgc(K);
+    kgc_histogram h;
+    klispC_histogram(K, &h);
+
+    TValue res = KNIL;
+    TValue count = KINERT, bytes = KINERT;
+    krooted_vars_push(K, &res);
+    krooted_vars_push(K, &count);
+    krooted_vars_push(K, &bytes);
+    for (int32_t tt = KGC_NTYPES - 1; tt >= 0; tt--) {
+        if (h.count[tt] == 0) continue;
+        count = kinteger_new_uint64(K, h.count[tt]);
+        bytes = kinteger_new_uint64(K, h.bytes[tt]);
+        TValue sym = ksymbol_new_b(K, klispC_typename(tt), KNIL);
+        krooted_tvs_push(K, sym);
+        TValue entry = klist(K, 3, sym, count, bytes);
+        krooted_tvs_pop(K);
+        krooted_tvs_push(K, entry);
+        res = kcons(K, entry, res);
+        krooted_tvs_pop(K);
+    }
+    krooted_vars_pop(K);
+    krooted_vars_pop(K);
+    krooted_vars_pop(K);
+    kapply_cc(K, res);
+}
+
+/*
+** Sampling profiler (these are klisp extensions)
+*/
+
+/* ?.? start-profiler */
+void start_profiler(klisp_State *K)
+{
+    TValue ptree = K->next_value;
+    TValue usecs = ptree;
+    
+    int32_t interval = 1000; /* default: 1 ms */
+    if (get_opt_tpar(K, usecs, "fixint", ttisfixint)) {
+        interval = ivalue(usecs);
+        if (interval <= 0) {
+            klispE_throw_simple_with_irritants(K, "interval should be "
+                                               "positive", 1, usecs);
+            return;
+        }
+    }
+    klispP_start(K, interval);
+    kapply_cc(K, KINERT);
+}
+
+/* ?.? stop-profiler */
+void stop_profiler(klisp_State *K)
+{
+    TValue ptree = K->next_value;
+    check_0p(K, ptree);
+    klispP_stop(K);
+    kapply_cc(K, KINERT);
+}
+
+/* ?.? reset-profiler */
+void reset_profiler(klisp_State *K)
+{
+    TValue ptree = K->next_value;
+    check_0p(K, ptree);
+    klispP_reset(K);
+    kapply_cc(K, KINERT);
+}
+
+/* ?.? profiler-samples */
+void profiler_samples(klisp_State *K)
+{
+    TValue ptree = K->next_value;
+    check_0p(K, ptree);
+
+    TValue tab = G(K)->prof_table;
+    TValue key = KFREE, data;
+    TValue res = KNIL;
+    krooted_tvs_push(K, tab); /* the table may be reset */
+    krooted_vars_push(K, &res);
+    while(klispH_next(K, tv2table(tab), &key, &data)) {
+        TValue entry = kcons(K, key, data);
+        krooted_tvs_push(K, entry);
+        res = kcons(K, entry, res);
+        krooted_tvs_pop(K);
+    }
+    krooted_vars_pop(K);
+    krooted_tvs_pop(K);
+    kapply_cc(K, res);
+}
+
+/* ?.? write-profile */
+/* writes the samples as folded stacks, one per line: the frames 
+   separated by ';', a space and the number of samples (this is the
+   format used by flamegraph.pl & friends) */
+void write_profile(klisp_State *K)
+{
+    TValue ptree = K->next_value;
+    TValue port = ptree;
+
+    if (!get_opt_tpar(K, port, "port", ttisport)) {
+        port = kcurr_output_port(K);
+    } 
+
+    if (!kport_is_output(port)) {
+        klispE_throw_simple(K, "the port should be an output port");
+        return;
+    } else if (!kport_is_textual(port)) {
+        klispE_throw_simple(K, "the port should be a textual port");
+        return;
+    } else if (kport_is_closed(port)) {
+        klispE_throw_simple(K, "the port is already closed");
+        return;
+    }
+
+    TValue tab = G(K)->prof_table;
+    TValue key = KFREE, data;
+    krooted_tvs_push(K, tab);
+    krooted_tvs_push(K, port);
+    while(klispH_next(K, tv2table(tab), &key, &data)) {
+        kwrite_display_to_port(K, port, key, true);
+        kwrite_char_to_port(K, port, ch2tv(' '));
+        kwrite_display_to_port(K, port, data, true);
+        kwrite_newline_to_port(K, port);
+    }
+    krooted_tvs_pop(K);
+    krooted_tvs_pop(K);
+    kapply_cc(K, KINERT);
+}
+
+/*
+** Call counting (these are klisp extensions)
+*/
+
+/* ?.? start-call-counting */
+void start_call_counting(klisp_State *K)
+{
+    TValue ptree = K->next_value;
+    check_0p(K, ptree);
+    klispP_start_calls(K);
+    kapply_cc(K, KINERT);
+}
+
+/* ?.? stop-call-counting */
+void stop_call_counting(klisp_State *K)
+{
+    TValue ptree = K->next_value;
+    check_0p(K, ptree);
+    klispP_stop_calls(K);
+    kapply_cc(K, KINERT);
+}
+
+/* ?.? reset-call-counts */
+void reset_call_counts(klisp_State *K)
+{
+    TValue ptree = K->next_value;
+    check_0p(K, ptree);
+    klispP_reset_calls(K);
+    kapply_cc(K, KINERT);
+}
+
+/* ?.? call-counts */
+void call_counts(klisp_State *K)
+{
+    TValue ptree = K->next_value;
+    check_0p(K, ptree);
+    kapply_cc(K, klispP_call_counts(K));
+}
+
 /* init ground */
 void kinit_system_ground_env(klisp_State *K)
 {
@@ -300,4 +530,23 @@ void kinit_system_ground_env(klisp_State *K)
                     get_environment_variable, 0);
     add_applicative(K, ground_env, "get-environment-variables", 
                     get_environment_variables, 1, create_env_var_list(K));
+    /* ?.? collect-garbage, gc-statistics, heap-statistics */
+    add_applicative(K, ground_env, "collect-garbage", collect_garbage, 0);
+    add_applicative(K, ground_env, "gc-statistics", gc_statistics, 0);
+    add_applicative(K, ground_env, "heap-statistics", heap_statistics, 0);
+    /* ?.? start-profiler, stop-profiler, reset-profiler, 
+       profiler-samples, write-profile */
+    add_applicative(K, ground_env, "start-profiler", start_profiler, 0);
+    add_applicative(K, ground_env, "stop-profiler", stop_profiler, 0);
+    add_applicative(K, ground_env, "reset-profiler", reset_profiler, 0);
+    add_applicative(K, ground_env, "profiler-samples", profiler_samples, 0);
+    add_applicative(K, ground_env, "write-profile", write_profile, 0);
+    /* ?.? start-call-counting, stop-call-counting, reset-call-counts,
+       call-counts */
+    add_applicative(K, ground_env, "start-call-counting", start_call_counting, 
+                    0);
+    add_applicative(K, ground_env, "stop-call-counting", stop_call_counting, 
+                    0);
+    add_applicative(K, ground_env, "reset-call-counts", reset_call_counts, 0);
+    add_applicative(K, ground_env, "call-counts", call_counts, 0);
 }
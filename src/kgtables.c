@@ -56,6 +56,20 @@
  *   Create new, empty hash table. Currently accepts no optional
  *   parameters (SRFI-69 allows user-defined hash function, etc.)
  *
+ * (make-weak-key-hash-table)
+ * (make-weak-value-hash-table)
+ * (make-ephemeron-hash-table)
+ *   Create new, empty weak hash tables (these are klisp extensions,
+ *   not in SRFI-69). A binding is removed from a weak key (value)
+ *   table when its key (value) is only reachable through weak
+ *   references. In weak key tables the values are held strongly, so
+ *   a value that refers to its own key keeps the binding alive. In
+ *   ephemeron tables a value is only reachable through the table
+ *   if its key is reachable from elsewhere, so cycles through values
+ *   don't keep keys alive. Bindings are removed when the garbage
+ *   collector runs. hash-table-copy and hash-table-merge always
+ *   create regular (strong) tables.
+ *
  * (hash-table-set! TABLE KEY VALUE)
  *   Set KEY => VALUE in TABLE, silently replacing
  *   any existing binding. The result is #inert.
@@ -124,6 +138,19 @@ static void make_hash_table(klisp_State *K)
     kapply_cc(K, tab);
 }
 
+static void make_weak_hash_table(klisp_State *K)
+{
+    /*
+    ** xparams[0]: wflags
+    */
+    check_0p(K, K->next_value);
+    TValue tab = klispH_new(K,
+                            0,  /* narray - not used in klisp */
+                            32, /* nhash - size of the hash table */
+                            ivalue(K->next_xparams[0]));
+    kapply_cc(K, tab);
+}
+
 static void hash_table_setB(klisp_State *K)
 {
     bind_3tp(K, K->next_value,
@@ -317,6 +344,13 @@ void kinit_tables_ground_env(klisp_State *K)
     add_applicative(K, ground_env, "hash-table?", typep, 2, symbol,
                     i2tv(K_TTABLE));
     add_applicative(K, ground_env, "make-hash-table", make_hash_table, 0);
+    add_applicative(K, ground_env, "make-weak-key-hash-table", 
+                    make_weak_hash_table, 1, i2tv(K_FLAG_WEAK_KEYS));
+    add_applicative(K, ground_env, "make-weak-value-hash-table", 
+                    make_weak_hash_table, 1, i2tv(K_FLAG_WEAK_VALUES));
+    add_applicative(K, ground_env, "make-ephemeron-hash-table", 
+                    make_weak_hash_table, 1, 
+                    i2tv(K_FLAG_WEAK_KEYS | K_FLAG_EPHEMERON));
 
     add_applicative(K, ground_env, "hash-table-set!", hash_table_setB, 0);
     add_applicative(K, ground_env, "hash-table-ref", hash_table_ref, 0);
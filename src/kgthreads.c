@@ -14,6 +14,8 @@
 #include "kobject.h"
 #include "kmutex.h"
 #include "kcondvar.h"
+#include "kchannel.h"
+#include "kfuture.h"
 #include "kghelpers.h"
 
 /* ?.1? thread? */
@@ -118,21 +120,10 @@ routine somewhere */
     return NULL;
 }
 
-/* ?.3? make-thread */
-static void make_thread(klisp_State *K)
+/* Create and start a new thread that will call the operative top with
+   no arguments and an empty environment */
+static TValue start_thread(klisp_State *K, TValue top)
 {
-    TValue *xparams = K->next_xparams;
-    TValue ptree = K->next_value;
-    TValue denv = K->next_env;
-    klisp_assert(ttisenvironment(K->next_env));
-    UNUSED(xparams);
-    UNUSED(denv);
-
-    bind_1tp(K, ptree, "combiner", ttiscombiner, comb);
-    TValue top = comb;
-    while(ttisapplicative(top)) 
-        top = kunwrap(top);
-
     /* GC: threads are fixed, no need to protect it */
     klisp_State *new_K = klispT_newthread(K);
     TValue new_th = gc2th(new_K);
@@ -140,6 +131,8 @@ static void make_thread(klisp_State *K)
        no arguments and an empty environment */
     /* TODO set_cc */
     klispT_set_cc(new_K, G(K)->root_cont);
+    /* The new thread starts with the dynamic bindings in effect here */
+    new_K->kd_base_bindings = new_K->kd_bindings = K->kd_bindings;
     /* This will protect it from GC */
     new_K->next_env = kmake_empty_environment(K);
     TValue si = ktry_get_si(new_K, top);
@@ -161,12 +154,30 @@ static void make_thread(klisp_State *K)
         resetbit(new_K->gct, FIXEDBIT);
         klispE_throw_simple_with_irritants(K, "Error creating thread", 
                                            1, i2tv(ret));
-        return;
+        return KINERT;
     }
 
     /* this shouldn't fail */
     UNUSED(pthread_attr_destroy(&attr));
+    return new_th;
+}
+
+/* ?.3? make-thread */
+static void make_thread(klisp_State *K)
+{
+    TValue *xparams = K->next_xparams;
+    TValue ptree = K->next_value;
+    TValue denv = K->next_env;
+    klisp_assert(ttisenvironment(K->next_env));
+    UNUSED(xparams);
+    UNUSED(denv);
+
+    bind_1tp(K, ptree, "combiner", ttiscombiner, comb);
+    TValue top = comb;
+    while(ttisapplicative(top))
+        top = kunwrap(top);
 
+    TValue new_th = start_thread(K, top);
     /* thread created correctly, return it */
     kapply_cc(K, new_th);
 }
@@ -212,6 +223,486 @@ static void thread_join(klisp_State *K)
     }
 }
 
+/*
+** Parallel map & for-each over vectors.
+** The range of indices is split in chunks, one per worker. All the
+** chunks but the first are sent as tasks to the worker pool (see
+** below), and the current thread does the first chunk and then waits
+** for the rest. A chunk that no worker took yet when the current thread
+** gets to it is done by the current thread instead, so this can't
+** deadlock even if all the workers are busy (e.g. if this is called
+** from a future). Because of the GIL only one thread runs klisp code at
+** a time, so what actually runs in parallel are the parts that release
+** it (blocking I/O, waiting on mutexes and condition variables). If
+** each worker would get less than KPARALLEL_MINCHUNK elements this is
+** just a sequential map in the current thread.
+*/
+
+/* see the worker pool below */
+static TValue pool_submit(klisp_State *K, TValue top);
+
+/* Helper continuation for parallel map/for-each: call app on each
+   element of src in [i, end), storing the results in dst (if dst isn't
+   #inert) */
+static void do_parallel_chunk(klisp_State *K)
+{
+    TValue *xparams = K->next_xparams;
+    TValue obj = K->next_value;
+    klisp_assert(ttisnil(K->next_env));
+    /*
+    ** xparams[0]: app
+    ** xparams[1]: src vector
+    ** xparams[2]: dst vector or #inert
+    ** xparams[3]: index
+    ** xparams[4]: end
+    ** xparams[5]: denv
+    ** xparams[6]: dummyp
+    */
+    TValue app = xparams[0];
+    TValue src = xparams[1];
+    TValue dst = xparams[2];
+    int32_t i = ivalue(xparams[3]);
+    int32_t end = ivalue(xparams[4]);
+    TValue denv = xparams[5];
+    bool dummyp = bvalue(xparams[6]);
+
+    /* dummyp is used to kick start the chunk */
+    if (!dummyp) {
+        if (!ttisinert(dst))
+            kvector_buf(dst)[i] = obj;
+        ++i;
+    }
+
+    if (i == end) {
+        kapply_cc(K, KINERT);
+    } else {
+        TValue ptree = kcons(K, kvector_buf(src)[i], KNIL);
+        krooted_tvs_push(K, ptree);
+        TValue new_cont =
+            kmake_continuation(K, kget_cc(K), do_parallel_chunk, 7, app,
+                               src, dst, i2tv(i), i2tv(end), denv, KFALSE);
+        krooted_tvs_pop(K);
+        kset_cc(K, new_cont);
+        ktail_apply_ptree(K, app, ptree, denv);
+    }
+}
+
+/* Top operative of the chunk tasks, does one chunk unless the thread
+   that called parallel map/for-each already took it */
+static void parallel_worker(klisp_State *K)
+{
+    TValue *xparams = K->next_xparams;
+    TValue ptree = K->next_value;
+    TValue denv = K->next_env;
+    klisp_assert(ttisenvironment(K->next_env));
+    UNUSED(ptree);
+    UNUSED(denv);
+    /*
+    ** xparams[0]: app
+    ** xparams[1]: src vector
+    ** xparams[2]: dst vector or #inert
+    ** xparams[3]: start
+    ** xparams[4]: end
+    ** xparams[5]: denv
+    ** xparams[6]: (taken? . ())
+    */
+    TValue taken = xparams[6];
+    if (kis_true(kcar(taken))) {
+        kapply_cc(K, KINERT);
+    }
+    kset_car(taken, KTRUE);
+
+    TValue new_cont =
+        kmake_continuation(K, kget_cc(K), do_parallel_chunk, 7, xparams[0],
+                           xparams[1], xparams[2], xparams[3], xparams[4],
+                           xparams[5], KTRUE);
+    kset_cc(K, new_cont);
+    /* this will be a nop, and will continue with do_parallel_chunk */
+    kapply_cc(K, KINERT);
+}
+
+/* Helper continuation for parallel map/for-each: do the chunks that no
+   worker took yet, wait for the others and return the result, or throw
+   the error of the first chunk that failed */
+static void do_parallel_join(klisp_State *K)
+{
+    TValue *xparams = K->next_xparams;
+    TValue obj = K->next_value;
+    klisp_assert(ttisnil(K->next_env));
+    /*
+    ** xparams[0]: list of (future . top) of the remaining chunks
+    ** xparams[1]: result
+    */
+    UNUSED(obj);
+
+    TValue ls = xparams[0];
+    while(!ttisnil(ls)) {
+        TValue future = kcaar(ls);
+        TValue *cxparams = tv2op(kcdar(ls))->extra;
+        TValue taken = cxparams[6];
+        if (!kis_true(kcar(taken))) {
+            /* do it here, and then continue with the rest */
+            kset_car(taken, KTRUE);
+            TValue join_cont =
+                kmake_continuation(K, kget_cc(K), do_parallel_join, 2,
+                                   kcdr(ls), xparams[1]);
+            kset_cc(K, join_cont); /* this protects it from GC */
+            TValue new_cont =
+                kmake_continuation(K, kget_cc(K), do_parallel_chunk, 7,
+                                   cxparams[0], cxparams[1], cxparams[2],
+                                   cxparams[3], cxparams[4], cxparams[5],
+                                   KTRUE);
+            kset_cc(K, new_cont);
+            /* this will be a nop, and will continue with do_parallel_chunk */
+            kapply_cc(K, KINERT);
+        }
+        /* LOCK: the GIL should be acquired exactly once */
+        kfuture_wait(K, future);
+        if (kfuture_state(future) == KFUTURE_ERROR) {
+            /* throw the same object, but in this thread */
+            kcall_cont(K, G(K)->error_cont, kfuture_value(future));
+            return;
+        }
+        ls = kcdr(ls);
+    }
+    kapply_cc(K, xparams[1]);
+}
+
+/* parallel-vector-map, parallel-for-each */
+static void parallel_map(klisp_State *K)
+{
+    TValue *xparams = K->next_xparams;
+    TValue ptree = K->next_value;
+    TValue denv = K->next_env;
+    klisp_assert(ttisenvironment(K->next_env));
+    /*
+    ** xparams[0]: map? (if false the results are discarded)
+    */
+    bool mapp = bvalue(xparams[0]);
+
+    bind_al2tp(K, ptree, "applicative", ttisapplicative, app,
+               "any", anytype, obj, maybe_workers);
+
+    int32_t workers = KPARALLEL_WORKERS;
+    if (get_opt_tpar(K, maybe_workers, "fixint", ttisfixint)) {
+        workers = ivalue(maybe_workers);
+        if (workers <= 0) {
+            klispE_throw_simple_with_irritants(K, "number of workers "
+                                               "should be positive", 1,
+                                               maybe_workers);
+            return;
+        }
+    }
+
+    /* copy the elements to a new vector, to avoid problems with
+       mutation */
+    TValue src;
+    if (ttisvector(obj)) {
+        src = kvector_new_bs_g(K, true, kvector_buf(obj),
+                               kvector_size(obj));
+    } else if (!mapp && (ttispair(obj) || ttisnil(obj))) {
+        /* parallel-for-each also takes finite lists */
+        int32_t pairs;
+        check_list(K, false, obj, &pairs, NULL);
+        src = list_to_vector_h(K, obj, pairs);
+    } else {
+        klispE_throw_simple(K, mapp? "Bad type on second argument "
+                            "(expected vector)" : "Bad type on second "
+                            "argument (expected vector or finite list)");
+        return;
+    }
+    krooted_tvs_push(K, src);
+
+    int32_t size = kvector_size(src);
+    TValue dst = mapp? kvector_new_sf(K, size, KINERT) : KINERT;
+    krooted_tvs_push(K, dst);
+
+    /* small chunks aren't worth the overhead */
+    workers = kmin32(workers, (size + KPARALLEL_MINCHUNK - 1) / 
+                     KPARALLEL_MINCHUNK);
+    int32_t chunk = workers > 0? (size + workers - 1) / workers : 0;
+
+    /* send the tasks for all the chunks but the first */
+    TValue chunks = KNIL;
+    krooted_vars_push(K, &chunks);
+    for (int32_t start = chunk; start < size; start += chunk) {
+        int32_t end = kmin32(start + chunk, size);
+        TValue taken = kcons(K, KFALSE, KNIL);
+        krooted_tvs_push(K, taken);
+        TValue top = kmake_operative(K, parallel_worker, 7, app, src, dst,
+                                     i2tv(start), i2tv(end), denv, taken);
+        krooted_tvs_pop(K);
+        krooted_tvs_push(K, top);
+        TValue future = pool_submit(K, top);
+        krooted_tvs_push(K, future);
+        TValue entry = kcons(K, future, top);
+        krooted_tvs_pop(K);
+        krooted_tvs_pop(K);
+        /* the last chunks go first, those are the ones less likely to
+           have been taken by a worker */
+        chunks = kcons(K, entry, chunks);
+    }
+
+    /* then do the first chunk here and join the rest */
+    TValue join_cont =
+        kmake_continuation(K, kget_cc(K), do_parallel_join, 2, chunks,
+                           dst);
+    kset_cc(K, join_cont); /* this protects it from GC */
+    TValue new_cont =
+        kmake_continuation(K, kget_cc(K), do_parallel_chunk, 7, app, src,
+                           dst, i2tv(0), i2tv(chunk), denv, KTRUE);
+    kset_cc(K, new_cont);
+    krooted_vars_pop(K);
+    krooted_tvs_pop(K);
+    krooted_tvs_pop(K);
+    /* this will be a nop, and will continue with do_parallel_chunk */
+    kapply_cc(K, KINERT);
+}
+
+/*
+** Worker pool & futures.
+** The pool is started the first time a task is sent (by future or the
+** parallel map & for-each), with KPOOL_WORKERS threads that run until
+** the state is closed (see kstop_pool, that sends each worker a stop
+** task).  Tasks are sent to the workers through an unbounded channel,
+** so idle workers wait on it without holding the GIL.  Each worker
+** runs the tasks in a loop, reusing its state and continuations, and
+** each task runs inside a guard that completes its future with the
+** error object if it throws one (instead of ending the worker
+** thread).  Like new threads, each task starts with the dynamic
+** bindings in effect where it was sent.
+** NOTE: touching a future from a task can deadlock if all the workers
+** end up waiting for tasks that are still in the queue.
+*/
+
+/* Interceptor for errors in pool tasks */
+static void do_int_pool_error(klisp_State *K)
+{
+    TValue *xparams = K->next_xparams;
+    TValue ptree = K->next_value;
+    TValue denv = K->next_env;
+    klisp_assert(ttisenvironment(K->next_env));
+    /*
+    ** xparams[0]: future
+    */
+    /* ptree is (object divert) */
+    TValue error_obj = kcar(ptree);
+    TValue divert = kcadr(ptree);
+
+    kfuture_complete(K, xparams[0], error_obj, true);
+    /* go back to the worker loop instead of passing the error along */
+    ktail_apply_ptree(K, divert, kcons(K, KINERT, KNIL), denv);
+}
+
+/* Loop of the pool workers: complete the future of the task that
+   just ended (if any) and run the next one */
+static void do_pool_worker(klisp_State *K)
+{
+    TValue *xparams = K->next_xparams;
+    TValue obj = K->next_value;
+    klisp_assert(ttisnil(K->next_env));
+    /*
+    ** xparams[0]: task queue
+    ** xparams[1]: future of the last task or #inert
+    */
+    TValue queue = xparams[0];
+    TValue future = xparams[1];
+
+    /* if the task threw an error the future was already completed
+       by the interceptor */
+    if (ttisfuture(future) && kfuture_pendingp(future))
+        kfuture_complete(K, future, obj, false);
+
+    /* this releases the GIL while there are no tasks */
+    TValue task = kchannel_receive(K, queue);
+    if (!ttispair(task)) {
+        /* stop task, return to the root continuation to end the thread */
+        kapply_cc(K, KINERT);
+        return;
+    }
+    krooted_tvs_push(K, task);
+    /* task is (future top . bindings) */
+    future = kcar(task);
+    K->kd_base_bindings = K->kd_bindings = kcddr(task);
+
+    TValue env = kmake_empty_environment(K);
+    krooted_tvs_push(K, env);
+    /* the loop continuation replaces this one, so the chain of
+       continuations doesn't grow with the number of tasks */
+    TValue loop_cont = kmake_continuation(K, kget_cc(K), do_pool_worker, 
+                                          2, queue, future);
+    kset_cc(K, loop_cont); /* this protects it from GC */
+    TValue outer_cont = kmake_continuation(K, loop_cont, do_pass_value, 
+                                           2, KNIL, env);
+    kset_outer_cont(outer_cont);
+    kset_cc(K, outer_cont); /* this protects it from GC */
+
+    TValue exit_int = kmake_operative(K, do_int_pool_error, 1, future);
+    krooted_tvs_push(K, exit_int);
+    TValue exit_guard = kcons(K, G(K)->error_cont, exit_int);
+    krooted_tvs_pop(K); /* already in guard */
+    krooted_tvs_push(K, exit_guard);
+    TValue exit_guards = kcons(K, exit_guard, KNIL);
+    krooted_tvs_pop(K); /* already in guards */
+    krooted_tvs_push(K, exit_guards);
+    TValue inner_cont = kmake_continuation(K, outer_cont, do_pass_value, 
+                                           2, exit_guards, env);
+    kset_inner_cont(inner_cont);
+    kset_cc(K, inner_cont); /* this protects it from GC */
+    krooted_tvs_pop(K); /* pop exit guards */
+    krooted_tvs_pop(K); /* pop env */
+    krooted_tvs_pop(K); /* pop task */
+
+    /* call the operative with no arguments and an empty environment */
+    ktail_call(K, kcadr(task), KNIL, env);
+}
+
+/* Top operative of the pool workers */
+static void pool_worker(klisp_State *K)
+{
+    TValue *xparams = K->next_xparams;
+    TValue ptree = K->next_value;
+    TValue denv = K->next_env;
+    klisp_assert(ttisenvironment(K->next_env));
+    UNUSED(ptree);
+    UNUSED(denv);
+    /*
+    ** xparams[0]: task queue
+    */
+    TValue new_cont = kmake_continuation(K, kget_cc(K), do_pool_worker, 
+                                         2, xparams[0], KINERT);
+    kset_cc(K, new_cont);
+    /* this will be a nop, and will continue with do_pool_worker */
+    kapply_cc(K, KINERT);
+}
+
+/* GC: Assumes nothing */
+static void start_pool(klisp_State *K)
+{
+    TValue queue = kmake_channel(K, 0);
+    krooted_tvs_push(K, queue);
+    TValue top = kmake_operative(K, pool_worker, 1, queue);
+    krooted_tvs_push(K, top);
+    for (int32_t i = 0; i < KPOOL_WORKERS; ++i) {
+        TValue th = start_thread(K, top);
+        /* keep the list of workers so that kstop_pool can stop them,
+           even if some later one fails to start */
+        G(K)->pool_threads = kcons(K, th, G(K)->pool_threads);
+        /* set as soon as there's a worker to run the tasks */
+        G(K)->pool_queue = queue;
+    }
+    krooted_tvs_pop(K);
+    krooted_tvs_pop(K);
+}
+
+/* LOCK: the GIL should be acquired exactly once */
+void kstop_pool(klisp_State *K)
+{
+    TValue threads = G(K)->pool_threads;
+    if (ttisnil(threads))
+        return;
+
+    TValue queue = G(K)->pool_queue;
+    /* one stop task per worker, each worker ends after receiving one */
+    for (TValue tail = threads; ttispair(tail); tail = kcdr(tail))
+        kchannel_send(K, queue, KINERT);
+
+    /* wait for all the workers to end (like thread-join) */
+    for (TValue tail = threads; ttispair(tail); tail = kcdr(tail)) {
+        klisp_State *K2 = tv2th(kcar(tail));
+        while (K2->status != KLISP_THREAD_DONE && 
+               K2->status != KLISP_THREAD_ERROR) {
+            /* LOCK: the GIL should be acquired exactly once */
+            int32_t ret = pthread_cond_wait(&K2->joincond, &G(K)->gil);
+            klisp_assert(ret == 0); /* shouldn't happen */
+        }
+    }
+    G(K)->pool_queue = KINERT;
+    G(K)->pool_threads = KNIL;
+}
+
+/* Send a task to the pool (starting it if necessary) to call the
+   operative top with no arguments and an empty environment, and return
+   the future that will hold the result */
+/* GC: Assumes top is rooted */
+static TValue pool_submit(klisp_State *K, TValue top)
+{
+    if (ttisinert(G(K)->pool_queue))
+        start_pool(K);
+
+    TValue new_future = kmake_future(K);
+    krooted_tvs_push(K, new_future);
+    TValue task = kcons(K, top, K->kd_bindings);
+    krooted_tvs_push(K, task);
+    task = kcons(K, new_future, task);
+    krooted_tvs_pop(K);
+    krooted_tvs_push(K, task);
+    /* the queue is unbounded, so this doesn't block */
+    kchannel_send(K, G(K)->pool_queue, task);
+    krooted_tvs_pop(K);
+    krooted_tvs_pop(K);
+    return new_future;
+}
+
+/* future? */
+/* uses typep */
+
+/* future */
+static void future(klisp_State *K)
+{
+    TValue *xparams = K->next_xparams;
+    TValue ptree = K->next_value;
+    TValue denv = K->next_env;
+    klisp_assert(ttisenvironment(K->next_env));
+    UNUSED(xparams);
+    UNUSED(denv);
+
+    bind_1tp(K, ptree, "combiner", ttiscombiner, comb);
+    TValue top = comb;
+    while(ttisapplicative(top))
+        top = kunwrap(top);
+
+    krooted_tvs_push(K, top);
+    TValue new_future = pool_submit(K, top);
+    krooted_tvs_pop(K);
+    kapply_cc(K, new_future);
+}
+
+/* touch */
+static void touch(klisp_State *K)
+{
+    TValue *xparams = K->next_xparams;
+    TValue ptree = K->next_value;
+    TValue denv = K->next_env;
+    klisp_assert(ttisenvironment(K->next_env));
+    UNUSED(xparams);
+    UNUSED(denv);
+
+    bind_1tp(K, ptree, "future", ttisfuture, future);
+    kfuture_wait(K, future);
+
+    if (kfuture_state(future) == KFUTURE_ERROR) {
+        /* throw the same object, but in this thread */
+        kcall_cont(K, G(K)->error_cont, kfuture_value(future));
+        return;
+    }
+    kapply_cc(K, kfuture_value(future));
+}
+
+/* future-done? */
+static void future_doneP(klisp_State *K)
+{
+    TValue *xparams = K->next_xparams;
+    TValue ptree = K->next_value;
+    TValue denv = K->next_env;
+    klisp_assert(ttisenvironment(K->next_env));
+    UNUSED(xparams);
+    UNUSED(denv);
+
+    bind_1tp(K, ptree, "future", ttisfuture, future);
+    kapply_cc(K, b2tv(!kfuture_pendingp(future)));
+}
+
 /* make-mutex */
 static void make_mutex(klisp_State *K)
 {
@@ -322,6 +813,142 @@ static void condvar_signal(klisp_State *K)
     kapply_cc(K, KINERT);
 }
 
+/* Channels */
+/* channel? */
+/* uses typep */
+
+/* make-channel */
+static void make_channel(klisp_State *K)
+{
+    TValue *xparams = K->next_xparams;
+    TValue ptree = K->next_value;
+    TValue denv = K->next_env;
+    klisp_assert(ttisenvironment(K->next_env));
+    UNUSED(xparams);
+    UNUSED(denv);
+
+    TValue maybe_cap = ptree;
+    uint32_t capacity = 0; /* unbounded */
+    if (get_opt_tpar(K, maybe_cap, "fixint", ttisfixint)) {
+        if (ivalue(maybe_cap) <= 0) {
+            klispE_throw_simple_with_irritants(K, "channel capacity "
+                                               "should be positive", 1,
+                                               maybe_cap);
+            return;
+        }
+        capacity = ivalue(maybe_cap);
+    }
+
+    TValue new_channel = kmake_channel(K, capacity);
+    kapply_cc(K, new_channel);
+}
+
+/* channel-send! */
+static void channel_sendB(klisp_State *K)
+{
+    TValue *xparams = K->next_xparams;
+    TValue ptree = K->next_value;
+    TValue denv = K->next_env;
+    klisp_assert(ttisenvironment(K->next_env));
+    UNUSED(xparams);
+    UNUSED(denv);
+
+    bind_2tp(K, ptree, "channel", ttischannel, channel, "any", anytype, obj);
+    /* channel & obj are rooted because they are part of the ptree */
+    kchannel_send(K, channel, obj);
+    kapply_cc(K, KINERT);
+}
+
+/* channel-receive */
+static void channel_receive(klisp_State *K)
+{
+    TValue *xparams = K->next_xparams;
+    TValue ptree = K->next_value;
+    TValue denv = K->next_env;
+    klisp_assert(ttisenvironment(K->next_env));
+    UNUSED(xparams);
+    UNUSED(denv);
+
+    bind_1tp(K, ptree, "channel", ttischannel, channel);
+    TValue obj = kchannel_receive(K, channel);
+    kapply_cc(K, obj);
+}
+
+/* channel-try-send! */
+static void channel_try_sendB(klisp_State *K)
+{
+    TValue *xparams = K->next_xparams;
+    TValue ptree = K->next_value;
+    TValue denv = K->next_env;
+    klisp_assert(ttisenvironment(K->next_env));
+    UNUSED(xparams);
+    UNUSED(denv);
+
+    bind_2tp(K, ptree, "channel", ttischannel, channel, "any", anytype, obj);
+    bool res = kchannel_try_send(K, channel, obj);
+    kapply_cc(K, b2tv(res));
+}
+
+/* channel-try-receive */
+static void channel_try_receive(klisp_State *K)
+{
+    TValue *xparams = K->next_xparams;
+    TValue ptree = K->next_value;
+    TValue denv = K->next_env;
+    klisp_assert(ttisenvironment(K->next_env));
+    UNUSED(xparams);
+    UNUSED(denv);
+
+    bind_al1tp(K, ptree, "channel", ttischannel, channel, default_obj);
+    if (!get_opt_tpar(K, default_obj, "any", anytype))
+        default_obj = KINERT;
+
+    TValue obj;
+    if (!kchannel_try_receive(K, channel, &obj))
+        obj = default_obj;
+    kapply_cc(K, obj);
+}
+
+/* channel-length */
+static void channel_length(klisp_State *K)
+{
+    TValue *xparams = K->next_xparams;
+    TValue ptree = K->next_value;
+    TValue denv = K->next_env;
+    klisp_assert(ttisenvironment(K->next_env));
+    UNUSED(xparams);
+    UNUSED(denv);
+
+    bind_1tp(K, ptree, "channel", ttischannel, channel);
+    kapply_cc(K, i2tv(kchannel_count(channel)));
+}
+
+/* channel-select */
+static void channel_select(klisp_State *K)
+{
+    TValue *xparams = K->next_xparams;
+    TValue ptree = K->next_value;
+    TValue denv = K->next_env;
+    klisp_assert(ttisenvironment(K->next_env));
+    UNUSED(xparams);
+    UNUSED(denv);
+
+    int32_t pairs;
+    check_typed_list(K, kchannelp, false, ptree, &pairs, NULL);
+    if (pairs == 0) {
+        klispE_throw_simple(K, "no channels to select from");
+        return;
+    }
+
+    /* ptree is rooted */
+    TValue obj;
+    TValue channel = kchannel_select(K, ptree, &obj);
+    krooted_tvs_push(K, obj);
+    TValue res = klist(K, 2, channel, obj);
+    krooted_tvs_pop(K);
+    kapply_cc(K, res);
+}
+
 /* init ground */
 void kinit_threads_ground_env(klisp_State *K)
 {
@@ -346,6 +973,23 @@ void kinit_threads_ground_env(klisp_State *K)
     /* ?.4? thread-join */
     add_applicative(K, ground_env, "thread-join", thread_join, 0);
 
+    /* parallel-vector-map, parallel-for-each */
+    add_applicative(K, ground_env, "parallel-vector-map", parallel_map, 1,
+                    b2tv(true));
+    add_applicative(K, ground_env, "parallel-for-each", parallel_map, 1,
+                    b2tv(false));
+
+    /* Futures */
+    /* future? */
+    add_applicative(K, ground_env, "future?", typep, 2, symbol, 
+                    i2tv(K_TFUTURE));
+    /* future */
+    add_applicative(K, ground_env, "future", future, 0);
+    /* touch */
+    add_applicative(K, ground_env, "touch", touch, 0);
+    /* future-done? */
+    add_applicative(K, ground_env, "future-done?", future_doneP, 0);
+
     /* Mutexes */
     /* mutex? */
     add_applicative(K, ground_env, "mutex?", typep, 2, symbol, 
@@ -380,4 +1024,32 @@ void kinit_threads_ground_env(klisp_State *K)
     /* condition-variable-broadcast */
     add_applicative(K, ground_env, "condition-variable-broadcast", 
                     condvar_signal, 1, b2tv(true));
+    /* Channels */
+    /* channel? */
+    add_applicative(K, ground_env, "channel?", typep, 2, symbol, 
+                    i2tv(K_TCHANNEL));
+    /* make-channel */
+    add_applicative(K, ground_env, "make-channel", make_channel, 0);
+    /* channel-send!, channel-receive */
+    add_applicative(K, ground_env, "channel-send!", channel_sendB, 0);
+    add_applicative(K, ground_env, "channel-receive", channel_receive, 0);
+    /* channel-try-send!, channel-try-receive */
+    add_applicative(K, ground_env, "channel-try-send!", 
+                    channel_try_sendB, 0);
+    add_applicative(K, ground_env, "channel-try-receive", 
+                    channel_try_receive, 0);
+    /* channel-length */
+    add_applicative(K, ground_env, "channel-length", channel_length, 0);
+    /* channel-select */
+    add_applicative(K, ground_env, "channel-select", channel_select, 0);
+}
+
+/* init continuation names */
+void kinit_threads_cont_names(klisp_State *K)
+{
+    Table *t = tv2table(G(K)->cont_name_table);
+
+    add_cont_name(K, t, do_parallel_chunk, "parallel-map-chunk");
+    add_cont_name(K, t, do_parallel_join, "parallel-map-join");
+    add_cont_name(K, t, do_pool_worker, "pool-worker");
 }
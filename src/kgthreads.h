@@ -11,6 +11,13 @@
 
 /* init ground */
 void kinit_threads_ground_env(klisp_State *K);
+/* init continuation names */
+void kinit_threads_cont_names(klisp_State *K);
+
+/* stop the worker pool (if it was started) and wait for the workers 
+   to end, this is called when closing the state */
+/* LOCK: the GIL should be acquired exactly once */
+void kstop_pool(klisp_State *K);
 
 #endif
 
@@ -53,6 +53,11 @@ void make_vector(klisp_State *K)
     kapply_cc(K, new_vector);
 }
 
+static bool kvector_or_gvectorp(TValue obj)
+{
+    return ttisvector(obj) || ttisgvector(obj);
+}
+
 /* (R7RS 3rd draft 6.3.6) vector-length */
 void vector_length(klisp_State *K)
 {
@@ -165,7 +170,7 @@ void vector_to_list(klisp_State *K)
     klisp_assert(ttisenvironment(K->next_env));
 
     TValue ptree = K->next_value;
-    bind_1tp(K, ptree, "vector", ttisvector, v);
+    bind_1tp(K, ptree, "vector", kvector_or_gvectorp, v);
 
     TValue res = vector_to_list_h(K, v, NULL);
     kapply_cc(K, res);
@@ -425,6 +430,191 @@ void vector_to_immutable_vector(klisp_State *K)
     kapply_cc(K, res);
 }
 
+/*
+** Growable vectors
+*/
+
+/* ??.?.? growable-vector? */
+/* uses typep */
+
+/* ??.?.? make-growable-vector */
+void make_growable_vector(klisp_State *K)
+{
+    klisp_assert(ttisenvironment(K->next_env));
+    TValue ptree = K->next_value;
+
+    TValue tv_cap = ptree;
+    if (!get_opt_tpar(K, tv_cap, "exact integer", keintegerp))
+        tv_cap = i2tv(0);
+
+    if (knegativep(tv_cap)) {
+        klispE_throw_simple(K, "negative capacity");
+        return;
+    } else if (!ttisfixint(tv_cap)) {
+        klispE_throw_simple(K, "capacity is too big");
+        return;
+    }
+    TValue new_gv = kgvector_new(K, ivalue(tv_cap));
+    kapply_cc(K, new_gv);
+}
+
+/* ??.?.? growable-vector-length */
+void growable_vector_length(klisp_State *K)
+{
+    klisp_assert(ttisenvironment(K->next_env));
+    TValue ptree = K->next_value;
+
+    bind_1tp(K, ptree, "growable vector", ttisgvector, gv);
+
+    TValue res = i2tv(kgvector_size(gv));
+    kapply_cc(K, res);
+}
+
+/* ??.?.? growable-vector-capacity */
+void growable_vector_capacity(klisp_State *K)
+{
+    klisp_assert(ttisenvironment(K->next_env));
+    TValue ptree = K->next_value;
+
+    bind_1tp(K, ptree, "growable vector", ttisgvector, gv);
+
+    TValue res = i2tv(kgvector_capacity(gv));
+    kapply_cc(K, res);
+}
+
+/* ??.?.? growable-vector-ref */
+void growable_vector_ref(klisp_State *K)
+{
+    klisp_assert(ttisenvironment(K->next_env));
+
+    TValue ptree = K->next_value;
+    bind_2tp(K, ptree, "growable vector", ttisgvector, gv,
+             "exact integer", keintegerp, tv_i);
+
+    if (!ttisfixint(tv_i) || ivalue(tv_i) < 0 || 
+        ivalue(tv_i) >= kgvector_size(gv)) {
+        klispE_throw_simple_with_irritants(K, "vector index out of bounds",
+                                           1, tv_i);
+        return;
+    }
+    kapply_cc(K, kgvector_buf(gv)[ivalue(tv_i)]);
+}
+
+/* ??.?.? growable-vector-set! */
+void growable_vector_setB(klisp_State *K)
+{
+    klisp_assert(ttisenvironment(K->next_env));
+
+    TValue ptree = K->next_value;
+    bind_3tp(K, ptree, "growable vector", ttisgvector, gv,
+             "exact integer", keintegerp, tv_i, "any", anytype, tv_new_value);
+
+    if (!ttisfixint(tv_i) || ivalue(tv_i) < 0 || 
+        ivalue(tv_i) >= kgvector_size(gv)) {
+        klispE_throw_simple_with_irritants(K, "vector index out of bounds",
+                                           1, tv_i);
+        return;
+    }
+    kgvector_buf(gv)[ivalue(tv_i)] = tv_new_value;
+    kapply_cc(K, KINERT);
+}
+
+/* ??.?.? growable-vector-push! */
+void growable_vector_pushB(klisp_State *K)
+{
+    klisp_assert(ttisenvironment(K->next_env));
+
+    TValue ptree = K->next_value;
+    bind_al1tp(K, ptree, "growable vector", ttisgvector, gv, objs);
+
+    int32_t pairs;
+    check_list(K, false, objs, &pairs, NULL);
+
+    /* reserve once for all the objects, the geometric growth in
+       push takes care of the single object case */
+    if (pairs > 1) {
+        uint64_t needed = (uint64_t) kgvector_size(gv) + pairs;
+        if (needed > INT32_MAX) {
+            klispE_throw_simple(K, "growable vector is too big");
+            return;
+        }
+        kgvector_reserve(K, gv, (uint32_t) needed);
+    }
+
+    /* gv & objs are rooted because they are part of the ptree */
+    while(pairs-- > 0) {
+        kgvector_push(K, gv, kcar(objs));
+        objs = kcdr(objs);
+    }
+    kapply_cc(K, KINERT);
+}
+
+/* ??.?.? growable-vector-pop! */
+void growable_vector_popB(klisp_State *K)
+{
+    klisp_assert(ttisenvironment(K->next_env));
+
+    TValue ptree = K->next_value;
+    bind_1tp(K, ptree, "growable vector", ttisgvector, gv);
+
+    int32_t size = kgvector_size(gv);
+    if (size == 0) {
+        klispE_throw_simple(K, "empty growable vector");
+        return;
+    }
+    /* the capacity is kept, shrink-to-fit! can be used to release it */
+    Vector *buf = tv2gvector(gv)->buf;
+    TValue res = buf->array[size-1];
+    buf->sizearray = size-1;
+    kapply_cc(K, res);
+}
+
+/* ??.?.? growable-vector-reserve! */
+void growable_vector_reserveB(klisp_State *K)
+{
+    klisp_assert(ttisenvironment(K->next_env));
+
+    TValue ptree = K->next_value;
+    bind_2tp(K, ptree, "growable vector", ttisgvector, gv,
+             "exact integer", keintegerp, tv_cap);
+
+    if (knegativep(tv_cap)) {
+        klispE_throw_simple(K, "negative capacity");
+        return;
+    } else if (!ttisfixint(tv_cap)) {
+        klispE_throw_simple(K, "capacity is too big");
+        return;
+    }
+    kgvector_reserve(K, gv, ivalue(tv_cap));
+    kapply_cc(K, KINERT);
+}
+
+/* ??.?.? growable-vector-shrink-to-fit! */
+void growable_vector_shrink_to_fitB(klisp_State *K)
+{
+    klisp_assert(ttisenvironment(K->next_env));
+
+    TValue ptree = K->next_value;
+    bind_1tp(K, ptree, "growable vector", ttisgvector, gv);
+
+    kgvector_shrink(K, gv);
+    kapply_cc(K, KINERT);
+}
+
+/* ??.?.? growable-vector->vector */
+void growable_vector_to_vector(klisp_State *K)
+{
+    klisp_assert(ttisenvironment(K->next_env));
+
+    TValue ptree = K->next_value;
+    bind_1tp(K, ptree, "growable vector", ttisgvector, gv);
+
+    /* the elements aren't copied, the buffer becomes the new vector
+       and gv is left empty */
+    TValue res = kgvector_to_vector(K, gv);
+    kapply_cc(K, res);
+}
+
 /* init ground */
 void kinit_vectors_ground_env(klisp_State *K)
 {
@@ -487,4 +677,33 @@ void kinit_vectors_ground_env(klisp_State *K)
     /* ?.? vector->immutable-vector */
     add_applicative(K, ground_env, "vector->immutable-vector",
                     vector_to_immutable_vector, 0);
+    /* ??.? growable-vector? */
+    add_applicative(K, ground_env, "growable-vector?", typep, 2, symbol,
+                    i2tv(K_TGVECTOR));
+    /* ??.? make-growable-vector */
+    add_applicative(K, ground_env, "make-growable-vector", 
+                    make_growable_vector, 0);
+    /* ??.? growable-vector-length, growable-vector-capacity */
+    add_applicative(K, ground_env, "growable-vector-length", 
+                    growable_vector_length, 0);
+    add_applicative(K, ground_env, "growable-vector-capacity", 
+                    growable_vector_capacity, 0);
+    /* ??.? growable-vector-ref, growable-vector-set! */
+    add_applicative(K, ground_env, "growable-vector-ref", 
+                    growable_vector_ref, 0);
+    add_applicative(K, ground_env, "growable-vector-set!", 
+                    growable_vector_setB, 0);
+    /* ??.? growable-vector-push!, growable-vector-pop! */
+    add_applicative(K, ground_env, "growable-vector-push!", 
+                    growable_vector_pushB, 0);
+    add_applicative(K, ground_env, "growable-vector-pop!", 
+                    growable_vector_popB, 0);
+    /* ??.? growable-vector-reserve!, growable-vector-shrink-to-fit! */
+    add_applicative(K, ground_env, "growable-vector-reserve!", 
+                    growable_vector_reserveB, 0);
+    add_applicative(K, ground_env, "growable-vector-shrink-to-fit!", 
+                    growable_vector_shrink_to_fitB, 0);
+    /* ??.? growable-vector->vector */
+    add_applicative(K, ground_env, "growable-vector->vector", 
+                    growable_vector_to_vector, 0);
 }
@@ -16,13 +16,7 @@
 
 static uint32_t get_keyword_hash(const char *buf, uint32_t size)
 {
-    uint32_t h = size; /* seed */
-    size_t step = (size>>5)+1; /* if string is too long, don't hash all 
-                                  its chars */
-    size_t size1;
-    for (size1 = size; size1 >= step; size1 -= step)  /* compute hash */
-        h = h ^ ((h<<5)+(h>>2)+ ((unsigned char) buf[size1-1]));
-
+    uint32_t h = klispS_hash((const uint8_t *) buf, size);
     h ^= (uint32_t) 0x55555555; 
     /* keyword hash should be different from string & symbol hash
        otherwise keywords and their respective immutable string
@@ -35,8 +29,7 @@ static uint32_t get_keyword_hash(const char *buf, uint32_t size)
 static Keyword *search_in_keyword_table(klisp_State *K, const char *buf, 
 					uint32_t size, uint32_t h)
 {
-    for (GCObject *o = G(K)->strt.hash[lmod(h, G(K)->strt.size)]; o != NULL; 
-         o = o->gch.next) {
+    for (GCObject *o = klispS_chain(K, h); o != NULL; o = o->gch.next) {
         klisp_assert(o->gch.tt == K_TKEYWORD || o->gch.tt == K_TSYMBOL || 
                      o->gch.tt == K_TSTRING || o->gch.tt == K_TBYTEVECTOR);
 		        
@@ -87,17 +80,7 @@ TValue kkeyword_new_bs(klisp_State *K, const char *buf, uint32_t size)
     new_keyw->hash = h;
 
     /* add to the string/keyword table (and link it) */
-    stringtable *tb;
-    tb = &G(K)->strt;
-    h = lmod(h, tb->size);
-    new_keyw->next = tb->hash[h];  /* chain new entry */
-    tb->hash[h] = (GCObject *)(new_keyw);
-    tb->nuse++;
-    if (tb->nuse > ((uint32_t) tb->size) && tb->size <= INT32_MAX / 2) {
-        krooted_tvs_push(K, ret_tv); /* save in case of gc */
-        klispS_resize(K, tb->size*2);  /* too crowded */
-        krooted_tvs_pop(K);
-    }
+    klispS_add(K, ret_tv, h);
     return ret_tv;
 }
 
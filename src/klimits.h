@@ -66,11 +66,62 @@
 #define MINTHREADTABSIZE	32
 #endif
 
+#ifndef MINPROFTABSIZE
+#define MINPROFTABSIZE	32
+#endif
+
 /* minimum size for the require table (must be power of 2) */
 #ifndef MINREQUIRETABSIZE
 #define MINREQUIRETABSIZE	32
 #endif
 
+/* minimum size for the library registry (must be power of 2) */
+#ifndef MINLIBRARYTABSIZE
+#define MINLIBRARYTABSIZE	32
+#endif
+
+/* minimum capacity for the buffer of growable vectors */
+#ifndef MINGVECTORSIZE
+#define MINGVECTORSIZE	8
+#endif
+
+/* entries in the per thread cache of dynamic variable lookups, 
+   should be a power of 2 */
+#ifndef KDCACHESIZE
+#define KDCACHESIZE	8
+#endif
+
+/* number of threads in the worker pool used by future */
+#ifndef KPOOL_WORKERS
+#define KPOOL_WORKERS	4
+#endif
+
+/* starting size for the buffer of unbounded channels */
+#ifndef MINCHANNELSIZE
+#define MINCHANNELSIZE	8
+#endif
+
+/* immutable strings longer than this aren't interned */
+#ifndef KMAXINTERNSTRLEN
+#define KMAXINTERNSTRLEN	40
+#endif
+
+/* minimum capacity for the buffer of string builders */
+#ifndef MINSTRBUILDERSIZE
+#define MINSTRBUILDERSIZE	32
+#endif
+
+/* default number of workers for parallel-vector-map & parallel-for-each */
+#ifndef KPARALLEL_WORKERS
+#define KPARALLEL_WORKERS	4
+#endif
+
+/* minimum number of elements per worker in parallel-vector-map & 
+   parallel-for-each, with less than this the work isn't split */
+#ifndef KPARALLEL_MINCHUNK
+#define KPARALLEL_MINCHUNK	8
+#endif
+
 /* starting size for ground environment hashtable */
 /* at last count, there were about 200 bindings in ground env */
 #define ENVTABSIZE	512
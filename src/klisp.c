@@ -84,7 +84,7 @@ static void k_message (const char *pname, const char *msg)
    (like the repl) */
 static void show_error(klisp_State *K, TValue obj) {
     /* FOR NOW used only for irritant list */
-    TValue port = kcdr(G(K)->kd_error_port_key);
+    TValue port = kcurr_error_port(K);
     klisp_assert(ttisfport(port) && kfport_file(port) == stderr);
 
     /* TEMP: obj should be an error obj */
@@ -290,7 +290,7 @@ static int dofile(klisp_State *K, const char *name)
 
     /* XXX better do this in a continuation */
     if (name == NULL) {
-        port = kcdr(G(K)->kd_in_port_key);
+        port = kcurr_input_port(K);
     } else {
         FILE *file = fopen(name, "r");
         if (file == NULL) {
@@ -193,6 +193,9 @@
 /* TODO use this defines everywhere */
 #define KTRACK_NAMES true
 #define KTRACK_SI true
+/* Call counting & timing (see kprofile.h), when compiled in but not
+   turned on (with start-call-counting) this costs only a test per call */
+#define KTRACK_CALLS true
 
 /* These are unused for now, but will be once incremental collection is 
    activated */
@@ -87,6 +87,7 @@ void *klispM_realloc_ (klisp_State *K, void *block, size_t osize, size_t nsize)
         klispC_fullgc(K);
 #ifdef KDEBUG_GC
         printf("GC END, total_bytes: %d\n", G(K)->totalbytes);
+        klispC_dump_histogram(K, stdout);
 #endif
     }
 #endif
@@ -102,5 +103,7 @@ void *klispM_realloc_ (klisp_State *K, void *block, size_t osize, size_t nsize)
     }
     klisp_assert((nsize == 0) == (block == NULL));
     G(K)->totalbytes = (G(K)->totalbytes - osize) + nsize;
+    if (nsize > osize)
+        G(K)->allocbytes += nsize - osize;
     return block;
 }
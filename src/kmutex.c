@@ -44,10 +44,17 @@ void kmutex_lock(klisp_State *K, TValue mutex)
         }
         ++kmutex_count(mutex);
     } else {
-        /* we need to release GIL to avoid deadlocks */
-        klisp_unlock(K);
-        int res = pthread_mutex_lock(&kmutex_mutex(mutex));
-        klisp_lock(K);
+        /* Fast path: if the mutex is free take it without releasing
+           the GIL, trylock never blocks so this can't deadlock */
+        int res = kmutex_is_owned(mutex)? EBUSY :
+            pthread_mutex_trylock(&kmutex_mutex(mutex));
+
+        if (res == EBUSY) {
+            /* we need to release GIL to avoid deadlocks */
+            klisp_unlock(K);
+            res = pthread_mutex_lock(&kmutex_mutex(mutex));
+            klisp_lock(K);
+        }
 
         if (res != 0) {
             klispE_throw_simple_with_irritants(K, "Can't lock mutex",
@@ -99,10 +106,8 @@ bool kmutex_trylock(klisp_State *K, TValue mutex)
     } else if (kmutex_is_owned(mutex)) {
         return false;
     } else {
-        /* we need to release GIL to avoid deadlocks */
-        klisp_unlock(K);
+        /* trylock never blocks, so there's no need to release the GIL */
         int res = pthread_mutex_trylock(&kmutex_mutex(mutex));
-        klisp_lock(K);
 
         if (res == 0) {
             klisp_assert(!kmutex_is_owned(mutex));
@@ -83,7 +83,12 @@ char *ktv_names[] = {
     [K_TFPORT] = "file port",
     [K_TMPORT] = "mem port",
     [K_TKEYWORD] = "keyword",
-    [K_TLIBRARY] = "library"
+    [K_TLIBRARY] = "library",
+    [K_TSTRBUILDER] = "string builder",
+    [K_TSLICE] = "slice",
+    [K_TGVECTOR] = "growable vector",
+    [K_TCHANNEL] = "channel",
+    [K_TFUTURE] = "future"
 };
 
 int32_t klispO_log2 (uint32_t x) {
@@ -175,6 +175,11 @@ typedef struct __attribute__ ((__packed__)) GCheader {
 #define K_TTHREAD	47
 #define K_TMUTEX	48
 #define K_TCONDVAR	49
+#define K_TSTRBUILDER	50
+#define K_TSLICE	51
+#define K_TGVECTOR	52
+#define K_TCHANNEL	53
+#define K_TFUTURE	54
 
 /* for tables */
 #define K_TDEADKEY           60
@@ -235,6 +240,11 @@ typedef struct __attribute__ ((__packed__)) GCheader {
 #define K_TAG_THREAD K_MAKE_VTAG(K_TTHREAD)
 #define K_TAG_MUTEX K_MAKE_VTAG(K_TMUTEX)
 #define K_TAG_CONDVAR K_MAKE_VTAG(K_TCONDVAR)
+#define K_TAG_STRBUILDER K_MAKE_VTAG(K_TSTRBUILDER)
+#define K_TAG_SLICE K_MAKE_VTAG(K_TSLICE)
+#define K_TAG_GVECTOR K_MAKE_VTAG(K_TGVECTOR)
+#define K_TAG_CHANNEL K_MAKE_VTAG(K_TCHANNEL)
+#define K_TAG_FUTURE K_MAKE_VTAG(K_TFUTURE)
 
 /*
 ** Macros to test types
@@ -340,6 +350,15 @@ typedef struct __attribute__ ((__packed__)) GCheader {
 #define ttisthread(o)	(tbasetype_(o) == K_TAG_THREAD)
 #define ttismutex(o)	(tbasetype_(o) == K_TAG_MUTEX)
 #define ttiscondvar(o)	(tbasetype_(o) == K_TAG_CONDVAR)
+#define ttisstrbuilder(o)	(tbasetype_(o) == K_TAG_STRBUILDER)
+#define ttisslice(o)	(tbasetype_(o) == K_TAG_SLICE)
+#define ttisgvector(o)	(tbasetype_(o) == K_TAG_GVECTOR)
+#define ttischannel(o)	(tbasetype_(o) == K_TAG_CHANNEL)
+#define ttisfuture(o)	(tbasetype_(o) == K_TAG_FUTURE)
+#define ttisstrslice(o_) ({ TValue s_ = (o_);                          \
+            ttisslice(s_) && ttisstring(tv2slice(s_)->parent);})
+#define ttisbvslice(o_) ({ TValue s_ = (o_);                           \
+            ttisslice(s_) && ttisbytevector(tv2slice(s_)->parent);})
 
 /* macros to easily check boolean values */
 #define kis_true(o_) (tv_equal((o_), KTRUE))
@@ -554,6 +573,20 @@ typedef struct __attribute__ ((__packed__)) {
     TValue array[]; /* array of elements */
 } Vector;
 
+/*
+** Growable vectors keep their elements in a Vector block that isn't
+** linked in the gc list (like the buffer of string builders).  It has
+** room for capacity elements and its sizearray field holds the number
+** of elements actually in use.  On growable-vector->vector it is
+** linked as a regular mutable vector and the growable vector is left
+** empty.
+*/
+typedef struct __attribute__ ((__packed__)) {
+    CommonHeader;
+    uint32_t capacity;
+    Vector *buf; /* NULL if capacity is 0 */
+} GVector;
+
 /* Unlike symbols, keywords can be marked because they don't record
    source info */
 typedef struct __attribute__ ((__packed__)) {
@@ -586,6 +619,40 @@ typedef struct __attribute__ ((__packed__)) {
     pthread_cond_t cond;
 } Condvar;
 
+/*
+** Channels keep the queued objects in a vector used as a ring buffer.
+** All fields are protected by the GIL, and blocked threads wait on the
+** condition variables with the GIL as mutex, so that a blocking
+** operation releases the GIL only once.  If capacity is 0 the channel
+** is unbounded and the buffer is replaced by a bigger one when full.
+*/
+typedef struct __attribute__ ((__packed__)) {
+    CommonHeader;
+    TValue buf; /* vector, the ring buffer */
+    uint32_t capacity; /* 0 if unbounded */
+    uint32_t head; /* index of the first queued object in buf */
+    uint32_t count; /* number of queued objects */
+    pthread_cond_t not_empty; /* signaled after each send */
+    pthread_cond_t not_full; /* signaled after each receive */
+} Channel;
+
+/* Possible states of a future */
+#define KFUTURE_PENDING (0)
+#define KFUTURE_DONE (1)
+#define KFUTURE_ERROR (2)
+
+/*
+** A future is the handle for a task run by the worker pool.  Like
+** channels, it is protected by the GIL and touch waits on the
+** condition variable with the GIL as mutex.
+*/
+typedef struct __attribute__ ((__packed__)) {
+    CommonHeader;
+    TValue value; /* the result/error object, once it isn't pending */
+    int32_t state;
+    pthread_cond_t done; /* broadcast when the task ends */
+} Future;
+
 /*
 ** `module' operation for hashing (size is always a power of 2)
 */
@@ -616,6 +683,32 @@ typedef struct __attribute__ ((__packed__)) {
     char b[]; /* buffer */
 } String;
 
+/*
+** The buffer of a string builder is a String block that isn't linked
+** in the gc list (and so it isn't an object yet).  It has room for
+** capacity chars plus the final '\0', and its size field holds the
+** number of chars already appended.  On string-builder->string it is
+** linked as a regular mutable string and the builder is left empty.
+*/
+typedef struct __attribute__ ((__packed__)) {
+    CommonHeader;
+    uint32_t capacity;
+    String *buf; /* NULL if capacity is 0 */
+} StrBuilder;
+
+/*
+** A slice is a read-only view of part of a string or bytevector.  It
+** shares the buffer of its parent (and keeps it alive), so creating
+** one doesn't copy any chars/bytes.  The parent is never a slice:
+** slicing a slice gives a new slice of the original parent.
+*/
+typedef struct __attribute__ ((__packed__)) {
+    CommonHeader;
+    TValue parent; /* string or bytevector */
+    uint32_t offset;
+    uint32_t size;
+} Slice;
+
 /* MAYBE: mark fields could be replaced by a hashtable or a bit + a hashtable */
 
 /*
@@ -742,6 +835,11 @@ const TValue kfree;
 #define gc2th(o_) (gc2tv(K_TAG_THREAD, o_))
 #define gc2mutex(o_) (gc2tv(K_TAG_MUTEX, o_))
 #define gc2condvar(o_) (gc2tv(K_TAG_CONDVAR, o_))
+#define gc2strb(o_) (gc2tv(K_TAG_STRBUILDER, o_))
+#define gc2slice(o_) (gc2tv(K_TAG_SLICE, o_))
+#define gc2gvector(o_) (gc2tv(K_TAG_GVECTOR, o_))
+#define gc2channel(o_) (gc2tv(K_TAG_CHANNEL, o_))
+#define gc2future(o_) (gc2tv(K_TAG_FUTURE, o_))
 #define gc2deadkey(o_) (gc2tv(K_TAG_DEADKEY, o_))
 
 /* Macro to convert a TValue into a specific heap allocated object */
@@ -768,6 +866,11 @@ const TValue kfree;
 #define tv2th(v_) ((klisp_State *) gcvalue(v_))
 #define tv2mutex(v_) ((Mutex *) gcvalue(v_))
 #define tv2condvar(v_) ((Condvar *) gcvalue(v_))
+#define tv2strb(v_) ((StrBuilder *) gcvalue(v_))
+#define tv2slice(v_) ((Slice *) gcvalue(v_))
+#define tv2gvector(v_) ((GVector *) gcvalue(v_))
+#define tv2channel(v_) ((Channel *) gcvalue(v_))
+#define tv2future(v_) ((Future *) gcvalue(v_))
 
 #define tv2gch(v_) ((GCheader *) gcvalue(v_))
 #define tv2mgch(v_) ((MGCheader *) gcvalue(v_))
@@ -906,11 +1009,16 @@ int32_t kmark_count;
 #define K_FLAG_WEAK_KEYS 0x01
 #define K_FLAG_WEAK_VALUES 0x02
 #define K_FLAG_WEAK_NOTHING 0x00
+/* ephemeron tables should also have weak keys: a value is only kept
+   while its key is reachable from outside the table */
+#define K_FLAG_EPHEMERON 0x04
 
 #define ktable_has_weak_keys(o_)                    \
     ((tv_get_kflags(o_) & K_FLAG_WEAK_KEYS) != 0)
 #define ktable_has_weak_values(o_)                  \
     ((tv_get_kflags(o_) & K_FLAG_WEAK_VALUES) != 0)
+#define ktable_is_ephemeron(o_)                     \
+    ((tv_get_kflags(o_) & K_FLAG_EPHEMERON) != 0)
 
 /* Macro to test the most basic equality on TValues */
 #define tv_equal(tv1_, tv2_) ((tv1_).raw == (tv2_).raw)
@@ -15,6 +15,7 @@
 #include "kerror.h"
 #include "kstring.h"
 #include "kbytevector.h"
+#include "kslice.h"
 #include "kgc.h"
 #include "kpair.h"
 
@@ -126,8 +127,10 @@ TValue kmake_std_fport(klisp_State *K, TValue filename, bool writep,
 TValue kmake_mport(klisp_State *K, TValue buffer, bool writep, bool binaryp)
 {
     klisp_assert(!writep || ttisinert(buffer));
-    klisp_assert(writep || (ttisbytevector(buffer) && binaryp) ||
-                 (ttisstring(buffer) && !binaryp));
+    /* input ports read directly from the passed string/bytevector or
+       slice, without copying it */
+    klisp_assert(writep || (ttisbvview(buffer) && binaryp) ||
+                 (ttisstrview(buffer) && !binaryp));
 
     if (writep) {
         buffer = binaryp? kbytevector_new_s(K, MINBYTEVECTORPORTBUFFER) :
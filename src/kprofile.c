@@ -0,0 +1,276 @@
+/*
+** kprofile.c
+** Sampling profiler
+** See Copyright Notice in klisp.h
+*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "kprofile.h"
+#include "kobject.h"
+#include "kstate.h"
+#include "kstring.h"
+#include "ksymbol.h"
+#include "ktable.h"
+#include "kenvironment.h"
+#include "kerror.h"
+#include "ksystem.h"
+#include "kbytevector.h"
+#include "kinteger.h"
+#include "kpair.h"
+
+volatile sig_atomic_t klispP_tick = 0;
+
+/* stacks deeper than this are truncated (the outermost frames are
+   replaced by "...") */
+#define KPROF_MAXDEPTH 64
+/* max length of a folded stack */
+#define KPROF_BUFSIZE 4096
+
+void klispP_start(klisp_State *K, int32_t usecs)
+{
+    global_State *g = G(K);
+    if (g->prof_running)
+        klispP_stop(K);
+
+    klispP_tick = 0;
+    if (!ksystem_start_prof_timer(K, usecs)) {
+        klispE_throw_simple(K, "profiling isn't supported in this platform");
+        return;
+    }
+    g->prof_running = true;
+}
+
+void klispP_stop(klisp_State *K)
+{
+    global_State *g = G(K);
+    if (g->prof_running) {
+        ksystem_stop_prof_timer(K);
+        g->prof_running = false;
+    }
+    klispP_tick = 0;
+}
+
+void klispP_reset(klisp_State *K)
+{
+    G(K)->prof_table = klispH_new(K, 0, MINPROFTABSIZE, 
+                                  K_FLAG_WEAK_NOTHING);
+}
+
+/* 
+** The name of a frame is the name of the combiner that is being called
+** (or that created the continuation), if it has one, otherwise the name
+** of the continuation type.  The source info is added if known.
+*/
+static int32_t frame_name(klisp_State *K, TValue obj, TValue si, 
+                          char *buf, int32_t size)
+{
+    const char *name = "?";
+    TValue comb = ttiscontinuation(obj)? tv2cont(obj)->comb : obj;
+
+    if ((ttisoperative(comb) || ttisapplicative(comb)) && khas_name(comb)) {
+        name = ksymbol_buf(kget_name(K, comb));
+    } else if (ttiscontinuation(obj)) {
+        const TValue *node = 
+            klispH_get(tv2table(G(K)->cont_name_table), 
+                       p2tv(tv2cont(obj)->fn));
+        if (node != &kfree)
+            name = kstring_buf(*node);
+    }
+
+    int32_t n;
+    if (ttispair(si) && ttisstring(ksi_filename(si))) {
+        n = snprintf(buf, size, "%s@%s:%d", name, 
+                     kstring_buf(ksi_filename(si)), ksi_line(si));
+    } else {
+        n = snprintf(buf, size, "%s", name);
+    }
+    return (n < 0 || n >= size)? size - 1 : n;
+}
+
+void klispP_sample(klisp_State *K)
+{
+    klispP_tick = 0;
+    global_State *g = G(K);
+    /* the timer may have fired just before it was stopped */
+    if (!g->prof_running || K->next_func == NULL)
+        return;
+
+    /* the innermost frame is what is about to be called (a combiner 
+       or a continuation), the rest are the current continuation & 
+       its ancestors */
+    TValue frames[KPROF_MAXDEPTH];
+    TValue sis[KPROF_MAXDEPTH];
+    int32_t depth = 0;
+
+    frames[depth] = K->next_obj;
+    sis[depth++] = K->next_si;
+
+    TValue cont = K->curr_cont;
+    while(ttiscontinuation(cont) && depth < KPROF_MAXDEPTH) {
+        frames[depth] = cont;
+        sis[depth++] = ktry_get_si(K, cont);
+        cont = tv2cont(cont)->parent;
+    }
+    bool truncatedp = ttiscontinuation(cont);
+
+    char buf[KPROF_BUFSIZE];
+    int32_t len = 0;
+    if (truncatedp) {
+        strcpy(buf, "...");
+        len = 3;
+    }
+    while(depth-- > 0 && len < KPROF_BUFSIZE - 2) {
+        if (len > 0)
+            buf[len++] = ';';
+        len += frame_name(K, frames[depth], sis[depth], 
+                          buf + len, KPROF_BUFSIZE - len);
+    }
+    buf[len] = '\0';
+
+    /* all the frames are reachable from K, no need to root them, and the
+       table doesn't move */
+    TValue stack = kstring_new_bs_imm(K, buf, len);
+    krooted_tvs_push(K, stack);
+    TValue *node = klispH_set(K, tv2table(g->prof_table), stack);
+    *node = ttisfixint(*node)? i2tv(ivalue(*node) + 1) : i2tv(1);
+    krooted_tvs_pop(K);
+}
+
+/*
+** Call counting
+** The counters for each key are two uint64_t (count & total usecs) kept 
+** in a bytevector, so that counting doesn't allocate (except the first
+** time a key is seen)
+*/
+#define KCALLS_COUNT 0
+#define KCALLS_USECS 1
+
+static inline uint64_t get_counter(TValue bv, int32_t i)
+{
+    uint64_t n;
+    memcpy(&n, kbytevector_buf(bv) + i * sizeof(uint64_t), sizeof(n));
+    return n;
+}
+
+static inline void set_counter(TValue bv, int32_t i, uint64_t n)
+{
+    memcpy(kbytevector_buf(bv) + i * sizeof(uint64_t), &n, sizeof(n));
+}
+
+void klispP_start_calls(klisp_State *K)
+{
+#if KTRACK_CALLS
+    global_State *g = G(K);
+    g->calls_last = KINERT;
+    g->calls_on = true;
+#else
+    klispE_throw_simple(K, "call counting wasn't compiled in "
+                        "(see KTRACK_CALLS)");
+#endif
+}
+
+void klispP_stop_calls(klisp_State *K)
+{
+    global_State *g = G(K);
+    g->calls_on = false;
+    g->calls_last = KINERT;
+}
+
+void klispP_reset_calls(klisp_State *K)
+{
+    global_State *g = G(K);
+    g->calls_last = KINERT;
+    g->calls_table = klispH_new(K, 0, MINPROFTABSIZE, K_FLAG_WEAK_KEYS);
+}
+
+#if KTRACK_CALLS
+void klispP_count_call(klisp_State *K, TValue key)
+{
+    global_State *g = G(K);
+    uint64_t now = ksystem_current_usecs(K);
+
+    /* the time since the last call was spent in it */
+    if (!ttisinert(g->calls_last)) {
+        set_counter(g->calls_last, KCALLS_USECS, 
+                    get_counter(g->calls_last, KCALLS_USECS) + 
+                    (now - g->calls_last_usecs));
+    }
+
+    TValue *node = klispH_set(K, tv2table(g->calls_table), key);
+    if (!ttisbytevector(*node)) {
+        /* first call, the key is rooted in K */
+        TValue counters = kbytevector_new_sf(K, 2 * sizeof(uint64_t), 0);
+        /* the table may have been rehashed */
+        *klispH_set(K, tv2table(g->calls_table), key) = counters;
+        g->calls_last = counters;
+    } else {
+        g->calls_last = *node;
+    }
+    set_counter(g->calls_last, KCALLS_COUNT, 
+                get_counter(g->calls_last, KCALLS_COUNT) + 1);
+    /* don't count the time spent here */
+    g->calls_last_usecs = ksystem_current_usecs(K);
+}
+#endif
+
+/* GC: assumes res is rooted */
+static void add_call_count(klisp_State *K, TValue res, TValue name, 
+                           uint64_t count, uint64_t usecs)
+{
+    /* name may only be referenced by a weak key */
+    krooted_tvs_push(K, name);
+    TValue c = kinteger_new_uint64(K, count);
+    krooted_tvs_push(K, c);
+    TValue u = kinteger_new_uint64(K, usecs);
+    krooted_tvs_push(K, u);
+    TValue entry = klist(K, 2, c, u);
+    krooted_tvs_push(K, entry);
+    *klispH_set(K, tv2table(res), name) = entry;
+    krooted_tvs_pop(K);
+    krooted_tvs_pop(K);
+    krooted_tvs_pop(K);
+    krooted_tvs_pop(K);
+}
+
+TValue klispP_call_counts(klisp_State *K)
+{
+    TValue tab = G(K)->calls_table;
+    krooted_tvs_push(K, tab); /* the table may be reset */
+    TValue res = klispH_new(K, 0, MINPROFTABSIZE, K_FLAG_WEAK_NOTHING);
+    krooted_tvs_push(K, res);
+    TValue key = KFREE, data;
+    /* continuations without a type name are added together */
+    uint64_t unknown_count = 0, unknown_usecs = 0;
+
+    while(klispH_next(K, tv2table(tab), &key, &data)) {
+        uint64_t count = get_counter(data, KCALLS_COUNT);
+        uint64_t usecs = get_counter(data, KCALLS_USECS);
+        TValue name = key;
+        if (ttisuser(key)) {
+            /* a continuation function, use the name of the type, 
+               these are unique */
+            const TValue *node = 
+                klispH_get(tv2table(G(K)->cont_name_table), key);
+            if (node == &kfree) {
+                unknown_count += count;
+                unknown_usecs += usecs;
+                continue;
+            }
+            name = *node;
+        }
+        add_call_count(K, res, name, count, usecs);
+    }
+
+    if (unknown_count > 0) {
+        TValue name = kstring_new_b_imm(K, "?");
+        krooted_tvs_push(K, name);
+        add_call_count(K, res, name, unknown_count, unknown_usecs);
+        krooted_tvs_pop(K);
+    }
+
+    krooted_tvs_pop(K);
+    krooted_tvs_pop(K);
+    return res;
+}
@@ -0,0 +1,48 @@
+/*
+** kprofile.h
+** Sampling profiler
+** See Copyright Notice in klisp.h
+*/
+
+#ifndef kprofile_h
+#define kprofile_h
+
+#include <signal.h>
+
+#include "kobject.h"
+#include "kstate.h"
+
+/*
+** The profiling timer (see ksystem) sets klispP_tick asynchronously, 
+** klispT_run checks it after each step and takes a sample of the 
+** current continuation chain if it is set.  Samples are kept in 
+** G(K)->prof_table as folded stacks (a string with the frames, 
+** outermost first, separated by ';') mapped to the number of times 
+** they were seen.
+*/
+extern volatile sig_atomic_t klispP_tick;
+
+/* LOCK: all these should be called with the GIL acquired */
+/* usecs is the sampling interval (of cpu time) */
+void klispP_start(klisp_State *K, int32_t usecs);
+void klispP_stop(klisp_State *K);
+void klispP_reset(klisp_State *K);
+void klispP_sample(klisp_State *K);
+
+/*
+** Call counting (only if KTRACK_CALLS is set, see klispconf.h)
+** While on, every call to an operative (in ktail_call_si) and every
+** return to a continuation (in kapply_cc) increments a counter for 
+** the operative or the continuation function, and the time until the
+** next call (as measured by ksystem_current_usecs()) is added to its 
+** total time.  The counters are kept in G(K)->calls_table.
+*/
+/* LOCK: all these should be called with the GIL acquired */
+void klispP_start_calls(klisp_State *K);
+void klispP_stop_calls(klisp_State *K);
+void klispP_reset_calls(klisp_State *K);
+/* returns a new table mapping each operative (or the name of the 
+   continuation type, as a string) to a list (count usecs) */
+TValue klispP_call_counts(klisp_State *K);
+
+#endif
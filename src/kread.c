@@ -210,7 +210,7 @@ TValue kread_fsm(klisp_State *K, bool listp)
         ** saved in np (later it will be replace by the source info
         ** of the car of the list)
         */
-        TValue si = ktok_get_source_info(K);
+        TValue si = ktok_get_obj_source_info(K);
         krooted_tvs_push(K, si);
 #if KTRACK_SI
         kset_source_info(K, np, si);
@@ -260,7 +260,7 @@ TValue kread_fsm(klisp_State *K, bool listp)
                     ** in np (later it will be replace by the source info
                     ** of the car of the list
                     */
-                    TValue si = ktok_get_source_info(K);
+                    TValue si = ktok_get_obj_source_info(K);
                     krooted_tvs_push(K, si);
 #if KTRACK_SI
                     kset_source_info(K, np, si);
@@ -298,7 +298,7 @@ TValue kread_fsm(klisp_State *K, bool listp)
 
                         obj = KNIL;
 #if KTRACK_SI
-                        obj_si = kget_source_info(K, fp_with_old_si);
+                        obj_si = ktry_get_si(K, fp_with_old_si);
 #else
                         UNUSED(fp_with_old_si);
                         obj_si = KNIL;
@@ -414,7 +414,7 @@ TValue kread_fsm(klisp_State *K, bool listp)
                         /* read defined object */
                         /* NOTE: save the source info to return it 
                            after the defined object is read */
-                        TValue si = ktok_get_source_info(K);
+                        TValue si = ktok_get_obj_source_info(K);
                         krooted_tvs_push(K, si);
                         push_data(K, kcons(K, tok, si));
                         krooted_tvs_pop(K);
@@ -442,7 +442,7 @@ TValue kread_fsm(klisp_State *K, bool listp)
                         /* ref ok, process it in next iteration */
                         obj = res;
                         /* NOTE: use source info of ref token */
-                        obj_si = ktok_get_source_info(K);
+                        obj_si = ktok_get_obj_source_info(K);
                         read_next_token = false;
                     }
                     }
@@ -478,7 +478,7 @@ TValue kread_fsm(klisp_State *K, bool listp)
                     pop_data(K);
                     obj = KNIL;
 #if KTRACK_SI
-                    obj_si = kget_source_info(K, fp_with_old_si);
+                    obj_si = ktry_get_si(K, fp_with_old_si);
 #else
                     UNUSED(fp_with_old_si);
                     obj_si = KNIL;
@@ -501,7 +501,7 @@ TValue kread_fsm(klisp_State *K, bool listp)
                 }
                 case ST_READ:
                     obj = tok;
-                    obj_si = ktok_get_source_info(K);
+                    obj_si = ktok_get_obj_source_info(K);
                     /* will exit in next loop */
                     read_next_token = false;
                     break;
@@ -535,7 +535,7 @@ TValue kread_fsm(klisp_State *K, bool listp)
                 } else {
                     /* token ok, process it in next iteration */
                     obj = tok;
-                    obj_si = ktok_get_source_info(K);
+                    obj_si = ktok_get_obj_source_info(K);
                     read_next_token = false;
                 }
             }
@@ -553,7 +553,7 @@ TValue kread_fsm(klisp_State *K, bool listp)
                 /* GC: the way things are done here fp is rooted at all
                    times */
 #if KTRACK_SI
-                TValue fp_old_si = kget_source_info(K, fp);
+                TValue fp_old_si = ktry_get_si(K, fp);
 #else
                 TValue fp_old_si = KNIL;
 #endif
@@ -684,13 +684,15 @@ TValue kread(klisp_State *K, bool listp)
 }
 
 /* port is protected from GC in curr_port */
-TValue kread_from_port_g(klisp_State *K, TValue port, bool mut, bool listp)
+TValue kread_from_port_g(klisp_State *K, TValue port, bool mut, bool listp,
+                         bool sip)
 {
     if (!tv_equal(port, K->curr_port)) {
         K->ktok_seen_eof = false; /* WORKAROUND: for repl problem with eofs */
         K->curr_port = port;
     }
     K->read_mconsp = mut;
+    K->read_sip = sip;
 
     ktok_set_source_info(K, kport_filename(port), 
                          kport_line(port), kport_col(port));
@@ -712,7 +714,18 @@ TValue kread_from_port(klisp_State *K, TValue port, bool mut)
     klisp_assert(kport_is_input(port));
     klisp_assert(kport_is_open(port));
     klisp_assert(kport_is_textual(port));
-    return kread_from_port_g(K, port, mut, false);
+    return kread_from_port_g(K, port, mut, false, true);
+}
+
+/* this doesn't save source info in the objects read, it's faster and
+   uses less memory (for reading data instead of code) */
+TValue kread_data_from_port(klisp_State *K, TValue port, bool mut)
+{
+    klisp_assert(ttisport(port));
+    klisp_assert(kport_is_input(port));
+    klisp_assert(kport_is_open(port));
+    klisp_assert(kport_is_textual(port));
+    return kread_from_port_g(K, port, mut, false, false);
 }
 
 TValue kread_list_from_port(klisp_State *K, TValue port, bool mut)
@@ -721,7 +734,7 @@ TValue kread_list_from_port(klisp_State *K, TValue port, bool mut)
     klisp_assert(kport_is_input(port));
     klisp_assert(kport_is_open(port));
     klisp_assert(kport_is_textual(port));
-    return kread_from_port_g(K, port, mut, true);
+    return kread_from_port_g(K, port, mut, true, true);
 }
 
 TValue kread_peek_char_from_port(klisp_State *K, TValue port, bool peek)
@@ -14,6 +14,7 @@
 ** Reader interface
 */
 TValue kread_from_port(klisp_State *K, TValue port, bool mut);
+TValue kread_data_from_port(klisp_State *K, TValue port, bool mut);
 TValue kread_list_from_port(klisp_State *K, TValue port, bool mut);
 TValue kread_peek_char_from_port(klisp_State *K, TValue port, bool peek);
 TValue kread_peek_u8_from_port(klisp_State *K, TValue port, bool peek);
@@ -43,7 +43,7 @@ void do_repl_read(klisp_State *K)
     /* show prompt */
     fprintf(stdout, KLISP_PROMPT);
 
-    TValue port = kcdr(G(K)->kd_in_port_key);
+    TValue port = kcurr_input_port(K);
     klisp_assert(kfport_file(port) == stdin);
     /* Workaround to the problem of the dangling '\n' in repl 
        (from previous line) */
@@ -140,7 +140,7 @@ void do_repl_loop(klisp_State *K)
     ** xparams[0]: dynamic environment
     */
 
-    TValue port = kcdr(G(K)->kd_out_port_key);
+    TValue port = kcurr_output_port(K);
     klisp_assert(kfport_file(port) == stdout);
 
     /* false: quote strings, escape chars */
@@ -171,7 +171,7 @@ void do_repl_int_error(klisp_State *K)
     TValue divert = kcadr(ptree);
 
     /* FOR NOW used only for irritant list */
-    TValue port = kcdr(G(K)->kd_error_port_key);
+    TValue port = kcurr_error_port(K);
     klisp_assert(ttisfport(port) && kfport_file(port) == stderr);
 
     /* TEMP: obj should be an error obj */
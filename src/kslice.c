@@ -0,0 +1,43 @@
+/*
+** kslice.c
+** Kernel String & Bytevector Slices
+** See Copyright Notice in klisp.h
+*/
+
+#include "kobject.h"
+#include "kstate.h"
+#include "kslice.h"
+#include "kmem.h"
+#include "kgc.h"
+
+/* GC: Assumes obj is rooted */
+TValue kmake_slice(klisp_State *K, TValue obj, uint32_t offset, 
+                   uint32_t size)
+{
+    klisp_assert(ttisstring(obj) || ttisbytevector(obj) || ttisslice(obj));
+
+    /* slices always point to the original string/bytevector, that way
+       there are no chains of slices to follow on every access */
+    if (ttisslice(obj)) {
+        klisp_assert(offset + size <= kslice_size(obj));
+        offset += kslice_offset(obj);
+        obj = kslice_parent(obj);
+    }
+
+    Slice *new_slice = klispM_new(K, Slice);
+
+    /* header + gc_fields */
+    klispC_link(K, (GCObject *) new_slice, K_TSLICE, 0);
+
+    /* slice specific fields */
+    new_slice->parent = obj;
+    new_slice->offset = offset;
+    new_slice->size = size;
+    return gc2slice(new_slice);
+}
+
+bool kslicep(TValue obj) { return ttisslice(obj); }
+bool kstring_slicep(TValue obj) { return ttisstrslice(obj); }
+bool kbytevector_slicep(TValue obj) { return ttisbvslice(obj); }
+bool kstrviewp(TValue obj) { return ttisstrview(obj); }
+bool kbvviewp(TValue obj) { return ttisbvview(obj); }
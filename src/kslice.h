@@ -0,0 +1,54 @@
+/*
+** kslice.h
+** Kernel String & Bytevector Slices
+** See Copyright Notice in klisp.h
+*/
+
+#ifndef kslice_h
+#define kslice_h
+
+#include "kobject.h"
+#include "kstate.h"
+#include "kstring.h"
+#include "kbytevector.h"
+
+/* GC: Assumes obj is rooted */
+/* obj should be a string, a bytevector or a slice, and
+   offset + size should be no bigger than its size */
+TValue kmake_slice(klisp_State *K, TValue obj, uint32_t offset, 
+                   uint32_t size);
+
+#define kslice_parent(s_) (tv2slice(s_)->parent)
+#define kslice_offset(s_) (tv2slice(s_)->offset)
+#define kslice_size(s_) (tv2slice(s_)->size)
+
+/*
+** Views: the read-only string operations accept either strings or
+** string slices, and these macros give the chars of both in the
+** same way (the same for bytevectors and bytevector slices).
+** NOTE: the buffers of the parents are never moved or resized, so the
+** pointers are valid as long as the view is rooted.
+*/
+#define ttisstrview(o_) ({ TValue v_ = (o_);            \
+            ttisstring(v_) || ttisstrslice(v_);})
+#define kstrview_buf(o_) ({ TValue v_ = (o_);                           \
+            ttisstring(v_)? kstring_buf(v_) :                           \
+                kstring_buf(kslice_parent(v_)) + kslice_offset(v_);})
+#define kstrview_size(o_) ({ TValue v_ = (o_);                          \
+            ttisstring(v_)? kstring_size(v_) : kslice_size(v_);})
+
+#define ttisbvview(o_) ({ TValue v_ = (o_);                     \
+            ttisbytevector(v_) || ttisbvslice(v_);})
+#define kbvview_buf(o_) ({ TValue v_ = (o_);                            \
+            ttisbytevector(v_)? kbytevector_buf(v_) :                   \
+                kbytevector_buf(kslice_parent(v_)) + kslice_offset(v_);})
+#define kbvview_size(o_) ({ TValue v_ = (o_);                           \
+            ttisbytevector(v_)? kbytevector_size(v_) : kslice_size(v_);})
+
+bool kslicep(TValue obj);
+bool kstring_slicep(TValue obj);
+bool kbytevector_slicep(TValue obj);
+bool kstrviewp(TValue obj);
+bool kbvviewp(TValue obj);
+
+#endif
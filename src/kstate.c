@@ -38,9 +38,11 @@
 #include "ktable.h"
 #include "kbytevector.h"
 #include "kvector.h"
+#include "kprofile.h"
 
 #include "kghelpers.h" /* for creating list_app & memoize_app */
 #include "kgerrors.h" /* for creating error hierarchy */
+#include "kgthreads.h" /* for stopping the worker pool */
 
 #include "kgc.h" /* for memory freeing & gc init */
 
@@ -89,6 +91,8 @@ static void f_klispopen (klisp_State *K, void *ud) {
     /* (at least for now) we'll use a non recursive mutex for the GIL */
     /* XXX/TODO check return code */
     pthread_mutex_init(&g->gil, NULL);
+    pthread_cond_init(&g->chancond, NULL);
+    g->chan_selecters = 0;
 
 /* This is here in lua, but in klisp we still need to alloc
    a bunch of objects:
@@ -109,6 +113,11 @@ static void preinit_state (klisp_State *K, global_State *g) {
     K->next_env = KNIL;
     K->next_xparams = NULL;
     K->next_si = KNIL;
+    K->kd_bindings = KNIL;
+    K->kd_base_bindings = KNIL;
+    K->kd_cache_bindings = KINERT;
+    for (int32_t i = 0; i < KDCACHESIZE; ++i)
+        K->kd_cache_keys[i] = K->kd_cache_binds[i] = KINERT;
 
     /* current input and output */
     K->curr_port = KINERT; /* set on each call to read/write */
@@ -136,6 +145,7 @@ static void preinit_state (klisp_State *K, global_State *g) {
     /* initialize reader */
     K->shared_dict = KNIL;
     K->read_mconsp = false; /* set on each call to read */
+    K->read_sip = true; /* set on each call to read */
 
     /* initialize writer */
     K->write_displayp = false; /* set on each call to write */
@@ -155,6 +165,10 @@ static void close_state(klisp_State *K)
 {
     global_State *g = G(K);
 
+    /* the pool workers wait on the queue channel, it can't be freed
+       while they are still running */
+    kstop_pool(K);
+
     /* collect all objects */
     klispC_freeall(K);
     klisp_assert(g->rootgc == obj2gco(K));
@@ -168,6 +182,7 @@ static void close_state(klisp_State *K)
 
     /* destroy the GIL */
     pthread_mutex_destroy(&g->gil);
+    pthread_cond_destroy(&g->chancond);
 
     /* only remaining mem should be of the state struct */
     klisp_assert(g->totalbytes == sizeof(KG));
@@ -209,9 +224,20 @@ klisp_State *klisp_newstate(klisp_Alloc f, void *ud)
     g->strt.size = 0;
     g->strt.nuse = 0;
     g->strt.hash = NULL;
+    g->strt.oldhash = NULL;
+    g->strt.oldsize = 0;
+    g->strt.rehashidx = 0;
     g->name_table = KINERT;
     g->cont_name_table = KINERT;
     g->thread_table = KINERT;
+    g->pool_queue = KINERT;
+    g->pool_threads = KNIL;
+    g->prof_running = false;
+    g->prof_table = KINERT;
+    g->calls_on = false;
+    g->calls_table = KINERT;
+    g->calls_last = KINERT;
+    g->calls_last_usecs = 0;
 
     g->empty_string = KINERT;
     g->empty_bytevector = KINERT;
@@ -257,6 +283,10 @@ klisp_State *klisp_newstate(klisp_Alloc f, void *ud)
     g->gcpause = KLISPI_GCPAUSE;
     g->gcstepmul = KLISPI_GCMUL;
     g->gcdept = 0;
+    g->gccount = 0;
+    g->gctime = 0;
+    g->gcmaxpause = 0;
+    g->allocbytes = 0;
 
     /* GC */
     g->totalbytes = state_size(KG) + KS_ISSIZE * sizeof(TValue) +
@@ -297,6 +327,12 @@ klisp_State *klisp_newstate(klisp_Alloc f, void *ud)
     /* here the keys are uncollectable */
     g->thread_table = klispH_new(K, 0, MINTHREADTABSIZE,
                                  K_FLAG_WEAK_NOTHING);
+    /* here the keys are immutable strings, see kprofile.c */
+    g->prof_table = klispH_new(K, 0, MINPROFTABSIZE,
+                               K_FLAG_WEAK_NOTHING);
+    /* weak keys, counting calls shouldn't keep combiners alive */
+    g->calls_table = klispH_new(K, 0, MINPROFTABSIZE,
+                                K_FLAG_WEAK_KEYS);
 
     /* Empty string */
     /* MAYBE: fix it so we can remove empty_string from roots */
@@ -334,7 +370,7 @@ klisp_State *klisp_newstate(klisp_Alloc f, void *ud)
     g->require_table = klispH_new(K, 0, MINREQUIRETABSIZE, 0);
 
     /* initialize library facilities */
-    g->libraries_registry = KNIL;
+    g->libraries_registry = klispH_new(K, 0, MINLIBRARYTABSIZE, 0);
 
     /* the dynamic ports and the keys for the dynamic ports */
     TValue in_port = kmake_std_fport(K, kstring_new_b_imm(K, "*STDIN*"),
@@ -482,6 +518,7 @@ void klisp_close (klisp_State *K)
 #endif
 
   /* luai_userstateclose(L); */
+    klispP_stop(K); /* don't leave the profiling timer running */
     close_state(K);
 }
 
@@ -566,6 +603,7 @@ void kcall_cont(klisp_State *K, TValue dst_cont, TValue obj)
     TValue new_cont;
     if (ttisnil(int_ls)) {
         new_cont = dst_cont; /* no interceptions */
+        klispT_restore_kd_bindings(K, dst_cont);
     } else {
         krooted_tvs_push(K, int_ls);
         /* we have to contruct a continuation to do the interceptions
@@ -589,6 +627,17 @@ void kcall_cont(klisp_State *K, TValue dst_cont, TValue obj)
     longjmp(K->error_jb, 1);
 }
 
+/* Set the dynamic bindings to the ones in effect in cont, that is, the
+   nearest binding continuation that is an improper ancestor of cont, or 
+   the bindings the thread started with if there isn't any */
+/* LOCK: GIL should be acquired */
+void klispT_restore_kd_bindings(klisp_State *K, TValue cont)
+{
+    while(!ttisnil(cont) && !kis_dyn_cont(cont))
+        cont = tv2cont(cont)->parent;
+    K->kd_bindings = ttisnil(cont)? K->kd_base_bindings : cont;
+}
+
 void klispT_init_repl(klisp_State *K)
 {
     /* this is in krepl.c */
@@ -616,6 +665,8 @@ void klispT_run(klisp_State *K)
                 /* next_func is either operative or continuation
                    but in any case the call is the same */
                 (*(K->next_func))(K);
+                if (klispP_tick)
+                    klispP_sample(K);
                 klispi_threadyield(K);
             }
             /* K->next_func is NULL, this means we should exit already */
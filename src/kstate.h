@@ -38,6 +38,10 @@ typedef struct stringtable {
     GCObject **hash;
     uint32_t nuse;  /* number of elements */
     int32_t size;
+    /* while growing, the previous array (see kstring.c) */
+    GCObject **oldhash; /* NULL if not growing */
+    int32_t oldsize;
+    int32_t rehashidx; /* next bucket in oldhash to be moved */
 } stringtable;
 
 #define GC_PROTECT_SIZE 32
@@ -79,6 +83,20 @@ typedef struct global_State {
     uint32_t gcdept;  /* how much GC is `behind schedule' */
     int32_t gcpause;  /* size of pause between successive GCs */
     int32_t gcstepmul;  /* GC `granularity' */
+    /* GC statistics (see kgc.h) */
+    uint32_t gccount;  /* number of collections */
+    uint64_t gctime;  /* total time spent collecting (in usecs) */
+    uint64_t gcmaxpause;  /* longest collection (in usecs) */
+    uint64_t allocbytes;  /* total number of bytes allocated since start */
+
+    /* Sampling profiler (see kprofile.h) */
+    bool prof_running; /* true if the profiling timer is on */
+    TValue prof_table; /* folded stack (string) -> number of samples */
+    /* Call counting (see kprofile.h), only used if KTRACK_CALLS */
+    bool calls_on; /* true if calls are being counted */
+    TValue calls_table; /* operative or cont fn -> counters */
+    TValue calls_last; /* counters for the last call, to add its time */
+    uint64_t calls_last_usecs; /* time of the last call */
 
     /* Basic Continuation objects */
     TValue root_cont; 
@@ -106,11 +124,12 @@ typedef struct global_State {
     TValue require_table;
 
     /* libraries */
-    TValue libraries_registry; /* this is a list, because library names
-                                are list of symbols and numbers so 
-                                putting them in a table isn't easy */
+    TValue libraries_registry; /* table indexed by a hash of the names,
+                                  library names are lists of symbols and
+                                  numbers (see kglibraries.c) */
 
-    /* XXX These should be changed to use thread specific storage */
+    /* These are the top level bindings, the dynamic bindings are kept
+       in each thread (see kd_bindings below) */
     /* for current-input-port, current-output-port, current-error-port */
     TValue kd_in_port_key;
     TValue kd_out_port_key;
@@ -136,6 +155,15 @@ typedef struct global_State {
        The number of times the lock was acquired is maintained in the 
        locking thread in gil_count */
     pthread_mutex_t gil; 
+    /* Threads blocked in channel-select wait here (with the GIL as
+       mutex), it is broadcast after each channel operation if
+       chan_selecters isn't 0 */
+    pthread_cond_t chancond;
+    int32_t chan_selecters; /* the number of threads in channel-select */
+    /* The task queue of the worker pool, a channel of (future . operative)
+       pairs, or #inert if the pool wasn't started yet */
+    TValue pool_queue;
+    TValue pool_threads; /* list of the worker threads */
 } global_State;
 
 /* 
@@ -175,6 +203,15 @@ struct klisp_State {
     /* TODO replace with GCObject *next_si */
     TValue next_si; /* the source code info for this call */
 
+    /* dynamic bindings of keyed dynamic variables (see kghelpers.c) */
+    TValue kd_bindings; /* innermost binding continuation or KNIL */
+    TValue kd_base_bindings; /* bindings inherited on thread creation */
+    /* cache of lookups, only valid while kd_bindings is kd_cache_bindings
+       (see klispT_kd_lookup) */
+    TValue kd_cache_bindings;
+    TValue kd_cache_keys[KDCACHESIZE];
+    TValue kd_cache_binds[KDCACHESIZE]; /* binding or KNIL for top level */
+
     /* TEMP: error handling */
     jmp_buf error_jb;
 
@@ -199,6 +236,7 @@ struct klisp_State {
     /* TODO: replace the list with a hashtable */
     TValue shared_dict;
     bool read_mconsp;
+    bool read_sip; /* false to read data without source info */
 
     /* writer */
     bool write_displayp;
@@ -246,6 +284,9 @@ union GCObject {
     MPort mport;
     Vector vector;
     Keyword keyw;
+    StrBuilder strb;
+    Slice slice;
+    GVector gvector;
     Library lib;
     klisp_State th; /* thread */
 };
@@ -474,12 +515,53 @@ static inline TValue kget_csi(klisp_State *K)
 {
     return K->next_si;
 }
+
+/*
+** The source info is a list (filename line . col), or, to use less
+** memory for the source info of objects read from files, a pair
+** (filename . line & col packed in one fixint) if they both fit.
+** Use these to access the source info fields.
+*/
+#define KSI_COL_BITS 10
+#define KSI_MAX_COL ((1 << KSI_COL_BITS) - 1)
+#define KSI_MAX_LINE ((1 << (31 - KSI_COL_BITS)) - 1)
+
+static inline TValue ksi_filename(TValue si) 
+{ 
+    return tv2pair(si)->car; 
+}
+
+static inline int32_t ksi_line(TValue si)
+{
+    TValue pos = tv2pair(si)->cdr;
+    return ttisfixint(pos)? ivalue(pos) >> KSI_COL_BITS :
+        ivalue(tv2pair(pos)->car);
+}
+
+static inline int32_t ksi_col(TValue si)
+{
+    TValue pos = tv2pair(si)->cdr;
+    return ttisfixint(pos)? ivalue(pos) & KSI_MAX_COL :
+        ivalue(tv2pair(pos)->cdr);
+}
 #endif
 
 /*
 ** Functions to manipulate the current continuation and calling 
 ** operatives
 */
+
+/* Call counting hook, key is the operative called or the function of
+   the continuation (as a user pointer) */
+#if KTRACK_CALLS
+/* GC: may allocate, but only the first time a key is seen */
+void klispP_count_call(klisp_State *K, TValue key);
+#define kcount_call(K_, key_)                                           \
+    { if (G(K_)->calls_on) klispP_count_call((K_), (key_)); }
+#else
+#define kcount_call(K_, key_) 
+#endif
+
 static inline void klispT_apply_cc(klisp_State *K, TValue val)
 {
     /* TODO write barriers */
@@ -498,6 +580,8 @@ static inline void klispT_apply_cc(klisp_State *K, TValue val)
     K->next_xparams = cont->extra;
     K->curr_cont = cont->parent;
     K->next_si = ktry_get_si(K, K->next_obj);
+    /* everything is in K at this point, so this can allocate */
+    kcount_call(K, p2tv(cont->fn));
 }
 
 #define kapply_cc(K_, val_) klispT_apply_cc((K_), (val_)); return
@@ -533,6 +617,8 @@ static inline void klispT_tail_call_si(klisp_State *K, TValue top, TValue ptree,
     K->next_env = env;
     K->next_xparams = op->extra;
     K->next_si = si;
+    /* everything is in K at this point, so this can allocate */
+    kcount_call(K, top);
 }
 
 #define ktail_call_si(K_, op_, p_, e_, si_)                             \
@@ -558,16 +644,76 @@ void klispT_init_repl(klisp_State *K);
 void klispT_run(klisp_State *K);
 void klisp_close (klisp_State *K);
 
-/* simple accessors for dynamic keys */
+/*
+** Keyed dynamic variables
+**
+** A dynamic key is a pair with a boolean in the car indicating if the
+** variable is bound at the top level and the top level value in the cdr.
+** Dynamic bindings are deep, and local to each thread: each binding is 
+** a continuation (marked with K_FLAG_DYNAMIC) with the key in extra[0], 
+** the value in extra[1] and the previous innermost binding in extra[2]. 
+** K->kd_bindings points to the innermost binding in effect, so binding 
+** is a single push and switching continuations just needs to restore
+** that pointer (see klispT_restore_kd_bindings()).
+** Lookups go through a small cache indexed by the address of the key,
+** that holds the binding found for the key (or nil if the top level
+** binding is in effect). Bindings are never mutated, so the cache stays 
+** valid for as long as kd_bindings doesn't change, and it is emptied
+** by the first lookup after a change.
+*/
+
+#define kd_cache_index(key_) \
+    ((int32_t) (((size_t) gcvalue(key_) >> 4) & (KDCACHESIZE - 1)))
+
+/* LOCK: GIL should be acquired */
+/* returns true if key is bound, and puts the value in *value */
+static inline bool klispT_kd_lookup(klisp_State *K, TValue key, 
+                                    TValue *value)
+{
+    if (!tv_equal(K->kd_cache_bindings, K->kd_bindings)) {
+        for (int32_t i = 0; i < KDCACHESIZE; ++i)
+            K->kd_cache_keys[i] = KINERT;
+        K->kd_cache_bindings = K->kd_bindings;
+    }
+
+    int32_t i = kd_cache_index(key);
+    TValue b;
+    if (tv_equal(K->kd_cache_keys[i], key)) {
+        b = K->kd_cache_binds[i];
+    } else {
+        b = K->kd_bindings;
+        while(!ttisnil(b) && !tv_equal(tv2cont(b)->extra[0], key))
+            b = tv2cont(b)->extra[2];
+        K->kd_cache_keys[i] = key;
+        K->kd_cache_binds[i] = b;
+    }
 
-/* XXX: this is ugly but we can't include kpair.h here so... */
-/* MAYBE: move car & cdr to kobject.h */
-/* TODO: use these where appropriate */
-/* TODO LOCK, thread local */
-#define kcurr_input_port(K) (tv2pair(G(K)->kd_in_port_key)->cdr)
-#define kcurr_output_port(K) (tv2pair(G(K)->kd_out_port_key)->cdr)
-#define kcurr_error_port(K) (tv2pair(G(K)->kd_error_port_key)->cdr)
-#define kcurr_strict_arithp(K) bvalue(tv2pair(G(K)->kd_strict_arith_key)->cdr)
+    if (!ttisnil(b)) {
+        *value = tv2cont(b)->extra[1];
+        return true;
+    }
+    /* not dynamically bound, use the top level binding */
+    Pair *p = tv2pair(key);
+    *value = p->cdr;
+    return kis_true(p->car);
+}
+
+/* this is for keys that are always bound */
+static inline TValue klispT_kd_value(klisp_State *K, TValue key)
+{
+    TValue value;
+    UNUSED(klispT_kd_lookup(K, key, &value));
+    return value;
+}
+
+void klispT_restore_kd_bindings(klisp_State *K, TValue cont);
+
+/* simple accessors for dynamic keys */
+#define kcurr_input_port(K) (klispT_kd_value(K, G(K)->kd_in_port_key))
+#define kcurr_output_port(K) (klispT_kd_value(K, G(K)->kd_out_port_key))
+#define kcurr_error_port(K) (klispT_kd_value(K, G(K)->kd_error_port_key))
+#define kcurr_strict_arithp(K)                                  \
+    bvalue(klispT_kd_value(K, G(K)->kd_strict_arith_key))
 
 #endif
 
@@ -0,0 +1,133 @@
+/*
+** kstrbuilder.c
+** Kernel String Builders
+** See Copyright Notice in klisp.h
+*/
+
+#include <string.h>
+
+#include "kobject.h"
+#include "kstate.h"
+#include "kstring.h"
+#include "kstrbuilder.h"
+#include "kmem.h"
+#include "kgc.h"
+#include "kerror.h"
+
+#define bufsize(cap_) (sizeof(String) + (cap_) + 1)
+
+TValue kmake_strbuilder(klisp_State *K, uint32_t capacity)
+{
+    StrBuilder *new_sb = klispM_new(K, StrBuilder);
+
+    /* header + gc_fields */
+    klispC_link(K, (GCObject *) new_sb, K_TSTRBUILDER, 0);
+
+    /* string builder specific fields */
+    new_sb->capacity = 0;
+    new_sb->buf = NULL;
+
+    TValue res = gc2strb(new_sb);
+    if (capacity > 0) {
+        krooted_tvs_push(K, res);
+        kstrbuilder_reserve(K, res, capacity);
+        krooted_tvs_pop(K);
+    }
+    return res;
+}
+
+void klispSB_free(klisp_State *K, StrBuilder *sb)
+{
+    if (sb->buf != NULL)
+        klispM_freemem(K, sb->buf, bufsize(sb->capacity));
+    klispM_free(K, sb);
+}
+
+/* GC: sb should be rooted */
+void kstrbuilder_reserve(klisp_State *K, TValue sb, uint32_t capacity)
+{
+    StrBuilder *b = tv2strb(sb);
+    if (capacity <= b->capacity)
+        return;
+
+    if (capacity > INT32_MAX) {
+        klispE_throw_simple(K, "resulting string is too big");
+        return;
+    }
+    /* NOTE: the gc may run here, but it doesn't look at the buffer */
+    String *buf = klispM_realloc_(K, b->buf, b->buf == NULL? 0 : 
+                                  bufsize(b->capacity), bufsize(capacity));
+    if (b->buf == NULL)
+        buf->size = 0;
+    b->buf = buf;
+    b->capacity = capacity;
+}
+
+/* GC: sb should be rooted, buf may be the buffer of a rooted string
+   (objects aren't moved by the gc) */
+void kstrbuilder_append(klisp_State *K, TValue sb, const char *buf, 
+                        uint32_t size)
+{
+    StrBuilder *b = tv2strb(sb);
+    uint32_t used = b->buf == NULL? 0 : b->buf->size;
+
+    if (size > INT32_MAX - used) {
+        klispE_throw_simple(K, "resulting string is too big");
+        return;
+    }
+    uint32_t needed = used + size;
+
+    if (needed > b->capacity) {
+        /* grow geometrically, so that appending n chars one at a time 
+           is O(n) */
+        uint64_t cap = ((uint64_t) b->capacity) * 2;
+        if (cap < MINSTRBUILDERSIZE)
+            cap = MINSTRBUILDERSIZE;
+        if (cap < needed)
+            cap = needed;
+        if (cap > INT32_MAX)
+            cap = INT32_MAX;
+        kstrbuilder_reserve(K, sb, (uint32_t) cap);
+    }
+    memcpy(b->buf->b + used, buf, size);
+    b->buf->size = needed;
+}
+
+/* GC: sb should be rooted */
+TValue kstrbuilder_to_string(klisp_State *K, TValue sb)
+{
+    StrBuilder *b = tv2strb(sb);
+    String *s = b->buf;
+    uint32_t capacity = b->capacity;
+
+    if (s == NULL || s->size == 0) {
+        if (s != NULL) {
+            b->buf = NULL;
+            b->capacity = 0;
+            klispM_freemem(K, s, bufsize(capacity));
+        }
+        return G(K)->empty_string;
+    }
+
+    /* first detach the buffer, so that the builder doesn't account for
+       it if the gc runs */
+    b->buf = NULL;
+    b->capacity = 0;
+
+    uint32_t size = s->size;
+    /* give back the unused part, without copying unless the allocator
+       decides to move the block */
+    if (size < capacity)
+        s = klispM_realloc_(K, s, bufsize(capacity), bufsize(size));
+
+    /* header + gc_fields */
+    klispC_link(K, (GCObject *) s, K_TSTRING, 0);
+
+    /* string specific fields */
+    s->hash = 0; /* unimportant for mutable strings */
+    s->mark = KFALSE;
+    s->size = size;
+    s->b[size] = '\0';
+
+    return gc2str(s);
+}
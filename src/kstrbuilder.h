@@ -0,0 +1,28 @@
+/*
+** kstrbuilder.h
+** Kernel String Builders
+** See Copyright Notice in klisp.h
+*/
+
+#ifndef kstrbuilder_h
+#define kstrbuilder_h
+
+#include "kobject.h"
+#include "kstate.h"
+
+TValue kmake_strbuilder(klisp_State *K, uint32_t capacity);
+void klispSB_free(klisp_State *K, StrBuilder *sb);
+
+/* GC: sb should be rooted */
+void kstrbuilder_append(klisp_State *K, TValue sb, const char *buf, 
+                        uint32_t size);
+void kstrbuilder_reserve(klisp_State *K, TValue sb, uint32_t capacity);
+/* GC: sb should be rooted */
+/* this hands over the buffer to the new string and leaves sb empty */
+TValue kstrbuilder_to_string(klisp_State *K, TValue sb);
+
+#define kstrbuilder_capacity(sb_) (tv2strb(sb_)->capacity)
+#define kstrbuilder_size(sb_) ({ String *b_ = tv2strb(sb_)->buf;  \
+            b_ == NULL? 0 : b_->size; })
+
+#endif
@@ -15,6 +15,145 @@
 #include "kmem.h"
 #include "kgc.h"
 
+/*
+** String table hashing
+** This replaces the lua hash, which skips chars in long strings and 
+** so makes strings that only differ in a few places (like generated 
+** symbols) fall in the same bucket.  All bytes are used here, read 4 
+** at a time and mixed with multiplications (as in murmur3).
+*/
+#define rotl32(x_, r_) (((x_) << (r_)) | ((x_) >> (32 - (r_))))
+
+uint32_t klispS_hash(const uint8_t *buf, uint32_t size)
+{
+    uint32_t h = size; /* seed */
+    uint32_t k;
+    const uint8_t *end = buf + (size & ~((uint32_t) 3));
+
+    for (; buf < end; buf += 4) {
+        memcpy(&k, buf, 4); /* buf may be unaligned */
+        k *= 0xcc9e2d51;
+        k = rotl32(k, 15);
+        k *= 0x1b873593;
+        h ^= k;
+        h = rotl32(h, 13);
+        h = h * 5 + 0xe6546b64;
+    }
+
+    k = 0;
+    switch(size & 3) {
+    case 3: k ^= ((uint32_t) buf[2]) << 16; /* fall through */
+    case 2: k ^= ((uint32_t) buf[1]) << 8; /* fall through */
+    case 1: k ^= (uint32_t) buf[0];
+        k *= 0xcc9e2d51;
+        k = rotl32(k, 15);
+        k *= 0x1b873593;
+        h ^= k;
+    }
+
+    /* final mix, so that all bits affect the bucket */
+    h ^= h >> 16;
+    h *= 0x85ebca6b;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35;
+    h ^= h >> 16;
+    return h;
+}
+
+/*
+** String table resizing
+** When the table grows, the new bucket array is installed right away
+** and the old one is kept in oldhash.  Old buckets are then moved a
+** few at a time on each insertion (KLISPS_REHASH_STEP), and also on 
+** demand: before a chain of the new array is used, the only old
+** bucket that could have entries for it is moved (sizes are powers of
+** two).  This way no single insertion has to rehash the whole table.
+** The GC finishes any pending move before sweeping the table, and 
+** shrinking (also done by the GC) is still done all at once.
+*/
+#define KLISPS_REHASH_STEP 4
+
+static uint32_t get_hash(GCObject *p)
+{
+    /* imm string, imm bytevectors & symbols aren't chained with 
+       all other objs, but with each other in strt */
+    klisp_assert(p->gch.tt == K_TKEYWORD || p->gch.tt == K_TSYMBOL || 
+                 p->gch.tt == K_TSTRING || p->gch.tt == K_TBYTEVECTOR);
+
+    switch(p->gch.tt) {
+    case K_TSYMBOL:
+        return ((Symbol *) p)->hash;
+    case K_TSTRING:
+        return ((String *) p)->hash;
+    case K_TBYTEVECTOR:
+        return ((Bytevector *) p)->hash;
+    case K_TKEYWORD:
+        return ((Keyword *) p)->hash;
+    default:
+        return 0;
+    }
+}
+
+/* move all objects in chain p to array newhash */
+static void rehash_chain(GCObject *p, GCObject **newhash, int32_t newsize)
+{
+    while (p) {  /* for each node in the list */
+        GCObject *next = p->gch.next;  /* save next */
+        uint32_t h = get_hash(p);
+        int32_t h1 = lmod(h, newsize);  /* new position */
+        klisp_assert((int32_t) (h%newsize) == lmod(h, newsize));
+        p->gch.next = newhash[h1];  /* chain it */
+        newhash[h1] = p;
+        p = next;
+    }
+}
+
+static void move_old_bucket(stringtable *tb, int32_t i)
+{
+    rehash_chain(tb->oldhash[i], tb->hash, tb->size);
+    tb->oldhash[i] = NULL;
+}
+
+/* move at most n buckets from the old array */
+static void rehash_step(klisp_State *K, int32_t n)
+{
+    stringtable *tb = &G(K)->strt;
+    klisp_assert(tb->oldhash != NULL);
+    while (n-- > 0 && tb->rehashidx < tb->oldsize)
+        move_old_bucket(tb, tb->rehashidx++);
+
+    if (tb->rehashidx >= tb->oldsize) { /* done */
+        klispM_freearray(K, tb->oldhash, tb->oldsize, GCObject *);
+        tb->oldhash = NULL;
+        tb->oldsize = 0;
+        tb->rehashidx = 0;
+    }
+}
+
+void klispS_finish_resize(klisp_State *K)
+{
+    stringtable *tb = &G(K)->strt;
+    if (tb->oldhash != NULL)
+        rehash_step(K, tb->oldsize);
+}
+
+/* start an incremental resize to double the size */
+static void grow(klisp_State *K)
+{
+    int32_t newsize = G(K)->strt.size * 2;
+    GCObject **newhash = klispM_newvector(K, newsize, GCObject *);
+    /* the GC may have run, it finishes pending moves & may shrink the table,
+       but the new size is still a multiple of the current one */
+    stringtable *tb = &G(K)->strt;
+    klisp_assert(tb->oldhash == NULL && newsize > tb->size);
+    for (int32_t i = 0; i < newsize; i++) newhash[i] = NULL;
+    tb->oldhash = tb->hash;
+    tb->oldsize = tb->size;
+    tb->rehashidx = 0;
+    tb->hash = newhash;
+    tb->size = newsize;
+}
+
 /* for immutable string/symbols/bytevector table */
 void klispS_resize (klisp_State *K, int32_t newsize)
 {
@@ -24,46 +163,49 @@ void klispS_resize (klisp_State *K, int32_t newsize)
     if (G(K)->gcstate == GCSsweepstring)
         return;  /* cannot resize during GC traverse */
     newhash = klispM_newvector(K, newsize, GCObject *);
+    klispS_finish_resize(K);
     tb = &G(K)->strt;
     for (i = 0; i < newsize; i++) newhash[i] = NULL;
     /* rehash */
-    for (i = 0; i < tb->size; i++) {
-        GCObject *p = tb->hash[i];
-        while (p) {  /* for each node in the list */
-            /* imm string, imm bytevectors & symbols aren't chained with 
-               all other objs, but with each other in strt */
-            GCObject *next = p->gch.next;  /* save next */
-            uint32_t h = 0;
-            klisp_assert(p->gch.tt == K_TKEYWORD || p->gch.tt == K_TSYMBOL || 
-                         p->gch.tt == K_TSTRING || p->gch.tt == K_TBYTEVECTOR);
-
-            switch(p->gch.tt) {
-            case K_TSYMBOL:
-                h = ((Symbol *) p)->hash;
-                break;
-            case K_TSTRING:
-                h = ((String *) p)->hash;
-                break;
-            case K_TBYTEVECTOR:
-                h = ((Bytevector *) p)->hash;
-                break;
-            case K_TKEYWORD:
-                h = ((Keyword *) p)->hash;
-                break;
-            }
-
-            int32_t h1 = lmod(h, newsize);  /* new position */
-            klisp_assert((int32_t) (h%newsize) == lmod(h, newsize));
-            p->gch.next = newhash[h1];  /* chain it */
-            newhash[h1] = p;
-            p = next;
-        }
-    }
+    for (i = 0; i < tb->size; i++)
+        rehash_chain(tb->hash[i], newhash, newsize);
     klispM_freearray(K, tb->hash, tb->size, GCObject *);
     tb->size = newsize;
     tb->hash = newhash;
 }
 
+/* Returns the first object in the chain for hash h */
+GCObject *klispS_chain(klisp_State *K, uint32_t h)
+{
+    stringtable *tb = &G(K)->strt;
+    if (tb->oldhash != NULL)
+        move_old_bucket(tb, lmod(h, tb->oldsize));
+    return tb->hash[lmod(h, tb->size)];
+}
+
+/* Adds a new immutable string, bytevector, symbol or keyword (with 
+   hash h) to the table */
+void klispS_add(klisp_State *K, TValue obj, uint32_t h)
+{
+    stringtable *tb = &G(K)->strt;
+    GCObject *o = gcvalue(obj);
+    if (tb->oldhash != NULL)
+        move_old_bucket(tb, lmod(h, tb->oldsize));
+    int32_t i = lmod(h, tb->size);
+    o->gch.next = tb->hash[i];  /* chain new entry */
+    tb->hash[i] = o;
+    tb->nuse++;
+
+    if (tb->oldhash != NULL) {
+        rehash_step(K, KLISPS_REHASH_STEP);
+    } else if (tb->nuse > ((uint32_t) tb->size) && 
+               tb->size <= INT32_MAX / 2) {
+        krooted_tvs_push(K, obj); /* save in case of gc */
+        grow(K);  /* too crowded */
+        krooted_tvs_pop(K);
+    }
+}
+
 /* General constructor for strings */
 TValue kstring_new_bs_g(klisp_State *K, bool m, const char *buf, 
                         uint32_t size)
@@ -78,14 +220,7 @@ TValue kstring_new_bs_g(klisp_State *K, bool m, const char *buf,
 
 static uint32_t get_string_hash(const char *buf, uint32_t size)
 {
-    uint32_t h = size; /* seed */
-    size_t step = (size>>5)+1; /* if string is too long, don't hash all 
-                                  its chars */
-    size_t size1;
-    for (size1 = size; size1 >= step; size1 -= step)  /* compute hash */
-        h = h ^ ((h<<5)+(h>>2)+ ((unsigned char) buf[size1-1]));
-
-    return h;
+    return klispS_hash((const uint8_t *) buf, size);
 }
 
 /* Looks for a string in the stringtable and returns a pointer
@@ -93,8 +228,7 @@ static uint32_t get_string_hash(const char *buf, uint32_t size)
 static String *search_in_string_table(klisp_State *K, const char *buf,
 				      uint32_t size, uint32_t h)
 {
-    for (GCObject *o = G(K)->strt.hash[lmod(h, G(K)->strt.size)];
-         o != NULL; o = o->gch.next) {
+    for (GCObject *o = klispS_chain(K, h); o != NULL; o = o->gch.next) {
         klisp_assert(o->gch.tt == K_TKEYWORD || o->gch.tt == K_TSYMBOL || 
                      o->gch.tt == K_TSTRING || o->gch.tt == K_TBYTEVECTOR);
 
@@ -113,9 +247,41 @@ static String *search_in_string_table(klisp_State *K, const char *buf,
 }
 
 
+/*
+** Only short immutable strings are interned.  Long ones (typically
+** big literals or strings read from input) would only bloat the 
+** string table and the hashing of all their chars may never be
+** needed.  These are linked with the rest of the objects, their hash
+** is computed the first time it is needed (see kstring_hash) and eq?
+** compares them by contents (see kstring_imm_eqp), so the fact that 
+** they aren't unique isn't visible.
+*/
+static TValue new_long_imm_string(klisp_State *K, const char *buf, 
+                                  uint32_t size)
+{
+    if (size > (SIZE_MAX - sizeof(String) - 1))
+        klispM_toobig(K);
+
+    String *new_str = (String *) klispM_malloc(K, sizeof(String) + size + 1);
+
+    /* header + gc_fields */
+    klispC_link(K, (GCObject *) new_str, K_TSTRING, K_FLAG_IMMUTABLE);
+
+    /* string specific fields */
+    new_str->hash = 0; /* not computed yet */
+    new_str->mark = KFALSE;
+    new_str->size = size;
+    memcpy(new_str->b, buf, size);
+    new_str->b[size] = '\0'; /* final 0 for printing */
+    return gc2str(new_str);
+}
+
 /* main constructor for immutable strings */
 TValue kstring_new_bs_imm(klisp_State *K, const char *buf, uint32_t size)
 {
+    if (size > KMAXINTERNSTRLEN)
+        return new_long_imm_string(K, buf, size);
+
     uint32_t h = get_string_hash(buf, size);
     
     /* first check to see if it's in the stringtable */
@@ -147,18 +313,8 @@ TValue kstring_new_bs_imm(klisp_State *K, const char *buf, uint32_t size)
     new_str->b[size] = '\0'; /* final 0 for printing */
 
     /* add to the string/symbol table (and link it) */
-    stringtable *tb;
-    tb = &G(K)->strt;
-    h = lmod(h, tb->size);
-    new_str->next = tb->hash[h];  /* chain new entry */
-    tb->hash[h] = (GCObject *)(new_str);
-    tb->nuse++;
     TValue ret_tv = gc2str(new_str);
-    if (tb->nuse > ((uint32_t) tb->size) && tb->size <= INT32_MAX / 2) {
-        krooted_tvs_push(K, ret_tv); /* save in case of gc */
-        klispS_resize(K, tb->size*2);  /* too crowded */
-        krooted_tvs_pop(K);
-    }
+    klispS_add(K, ret_tv, h);
     
     return ret_tv;
 }
@@ -241,6 +397,33 @@ bool kstring_equalp(TValue obj1, TValue obj2)
     }
 }
 
+/* the hash of long immutable strings is computed on demand */
+uint32_t kstring_hash(TValue str)
+{
+    klisp_assert(kstring_immutablep(str));
+    String *s = tv2str(str);
+    if (s->hash == 0 && s->size > KMAXINTERNSTRLEN)
+        s->hash = get_string_hash(s->b, s->size);
+    return s->hash;
+}
+
+/* eq? for strings: mutable and short immutable strings are eq? iff
+   they are the same object, long immutable strings are eq? iff they
+   have the same chars */
+bool kstring_imm_eqp(TValue str1, TValue str2)
+{
+    if (tv_equal(str1, str2))
+        return true;
+    else if (!kstring_immutablep(str1) || !kstring_immutablep(str2) ||
+             kstring_size(str1) != kstring_size(str2) || 
+             kstring_size(str1) <= KMAXINTERNSTRLEN)
+        return false;
+    else
+        return kstring_hash(str1) == kstring_hash(str2) &&
+            memcmp(kstring_buf(str1), kstring_buf(str2), 
+                   kstring_size(str1)) == 0;
+}
+
 bool kstringp(TValue obj) { return ttisstring(obj); }
 bool kimmutable_stringp(TValue obj)
 { 
@@ -16,6 +16,10 @@
 
 /* for immutable string table */
 void klispS_resize (klisp_State *K, int32_t newsize);
+void klispS_finish_resize(klisp_State *K);
+uint32_t klispS_hash(const uint8_t *buf, uint32_t size);
+GCObject *klispS_chain(klisp_State *K, uint32_t h);
+void klispS_add(klisp_State *K, TValue obj, uint32_t h);
 
 /* General constructor for strings */
 TValue kstring_new_bs_g(klisp_State *K, bool m, const char *buf, 
@@ -53,6 +57,13 @@ TValue kstring_new_sf(klisp_State *K, uint32_t size, char fill);
 #define kstring_emptyp(tv_) (kstring_size(tv_) == 0)
 #define kstring_mutablep(tv_) (kis_mutable(tv_))
 #define kstring_immutablep(tv_) (kis_immutable(tv_))
+/* only short immutable strings are in the string table */
+#define kstring_internedp(tv_) (kstring_immutablep(tv_) &&  \
+                                kstring_size(tv_) <= KMAXINTERNSTRLEN)
+
+/* these are only for immutable strings */
+uint32_t kstring_hash(TValue str);
+bool kstring_imm_eqp(TValue str1, TValue str2);
 
 /* both obj1 and obj2 should be strings, this compares char by char
    and doesn't differentiate immutable from mutable strings */
@@ -66,3 +66,84 @@ bool ksystem_isatty(klisp_State *K, TValue port)
 }
 
 #endif /* HAVE_PLATFORM_ISATTY */
+
+#ifndef HAVE_PLATFORM_USECS
+
+#include <time.h>
+
+/* TEMP use processor time, it's all ansi c gives us with enough 
+   resolution */
+uint64_t ksystem_current_usecs(klisp_State *K)
+{
+    UNUSED(K);
+    return (uint64_t) clock() * 1000000 / CLOCKS_PER_SEC;
+}
+
+#endif /* HAVE_PLATFORM_USECS */
+
+#ifndef HAVE_PLATFORM_PROF_TIMER
+
+bool ksystem_start_prof_timer(klisp_State *K, int32_t usecs)
+{
+    UNUSED(K);
+    UNUSED(usecs);
+    return false;
+}
+
+void ksystem_stop_prof_timer(klisp_State *K)
+{
+    UNUSED(K);
+}
+
+#endif /* HAVE_PLATFORM_PROF_TIMER */
+
+#ifndef HAVE_PLATFORM_PORT_READY
+
+#include "kpair.h"
+
+/* no way to know, so say that all ports are ready (that's what 
+   char-ready? & u8-ready? always did) */
+bool ksystem_port_ready(klisp_State *K, TValue port)
+{
+    UNUSED(K);
+    UNUSED(port);
+    return true;
+}
+
+/* GC: Assumes ports is rooted */
+TValue ksystem_wait_ports(klisp_State *K, TValue ports, int32_t n, 
+                          int32_t msecs)
+{
+    UNUSED(msecs);
+    TValue res = kcons(K, KNIL, KNIL);
+    krooted_vars_push(K, &res);
+    TValue last_pair = res;
+    TValue tail = ports;
+    for (int32_t i = 0; i < n; ++i, tail = kcdr(tail)) {
+        TValue new_pair = kcons(K, kcar(tail), KNIL);
+        kset_cdr(last_pair, new_pair);
+        last_pair = new_pair;
+    }
+    krooted_vars_pop(K);
+    return kcdr(res);
+}
+
+#endif /* HAVE_PLATFORM_PORT_READY */
+
+#ifndef HAVE_PLATFORM_PIPES
+
+TValue ksystem_make_pipe(klisp_State *K, bool binaryp)
+{
+    UNUSED(binaryp);
+    klispE_throw_simple(K, "pipes are not supported in this platform");
+    return KINERT;
+}
+
+TValue ksystem_make_socket_pair(klisp_State *K, bool binaryp)
+{
+    UNUSED(binaryp);
+    klispE_throw_simple(K, "sockets are not supported in this platform");
+    return KINERT;
+}
+
+#endif /* HAVE_PLATFORM_PIPES */
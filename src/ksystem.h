@@ -12,6 +12,27 @@
 TValue ksystem_current_jiffy(klisp_State *K);
 TValue ksystem_jiffies_per_second(klisp_State *K);
 bool ksystem_isatty(klisp_State *K, TValue port);
+/* this is for measuring intervals (e.g. gc pauses), not for dates */
+uint64_t ksystem_current_usecs(klisp_State *K);
+/* timer for the sampling profiler, sets klispP_tick every usecs 
+   of cpu time (see kprofile.h), returns false if not supported */
+bool ksystem_start_prof_timer(klisp_State *K, int32_t usecs);
+void ksystem_stop_prof_timer(klisp_State *K);
+/* readiness of ports: an input port is ready if reading a char/byte
+   wouldn't block, an output port if writing wouldn't. Memory ports
+   are always ready. Where this isn't supported all ports are ready */
+bool ksystem_port_ready(klisp_State *K, TValue port);
+/* waits (without the GIL) until at least one of the first n ports in
+   list ports is ready, or msecs milliseconds pass (msecs < 0 means no 
+   timeout), returns a list of the ready ports in the same order */
+/* GC: Assumes ports is rooted */
+TValue ksystem_wait_ports(klisp_State *K, TValue ports, int32_t n, 
+                          int32_t msecs);
+/* these return a list of file ports (input output) connected by a pipe,
+   and a list of two such lists, one for each end of a pair of connected 
+   sockets, respectively. They throw an error if not supported */
+TValue ksystem_make_pipe(klisp_State *K, bool binaryp);
+TValue ksystem_make_socket_pair(klisp_State *K, bool binaryp);
 
 #endif
 
@@ -5,17 +5,32 @@
 */
 
 #include <stdio.h>
+#include <string.h>
+#include <signal.h>
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
 #include <sys/time.h>
+#include <sys/socket.h>
 #include "kobject.h"
 #include "kstate.h"
 #include "kinteger.h"
 #include "kport.h"
+#include "kpair.h"
+#include "kstring.h"
+#include "kmem.h"
+#include "kerror.h"
 #include "ksystem.h"
+#include "kprofile.h"
 
 /* declare implemented functionality */
 
 #define HAVE_PLATFORM_JIFFIES
 #define HAVE_PLATFORM_ISATTY
+#define HAVE_PLATFORM_USECS
+#define HAVE_PLATFORM_PROF_TIMER
+#define HAVE_PLATFORM_PORT_READY
+#define HAVE_PLATFORM_PIPES
 
 /* jiffies */
 
@@ -44,6 +59,14 @@ TValue ksystem_jiffies_per_second(klisp_State *K)
     return i2tv(1000000);
 }
 
+uint64_t ksystem_current_usecs(klisp_State *K)
+{
+    UNUSED(K);
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (uint64_t) tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
 /* isatty */
 
 bool ksystem_isatty(klisp_State *K, TValue port)
@@ -51,3 +74,249 @@ bool ksystem_isatty(klisp_State *K, TValue port)
     return ttisfport(port) && kport_is_open(port)
         && isatty(fileno(kfport_file(port)));
 }
+
+/* profiling timer */
+
+static void prof_handler(int sig)
+{
+    UNUSED(sig);
+    klispP_tick = 1;
+}
+
+static bool set_prof_timer(int32_t usecs)
+{
+    struct itimerval it;
+    it.it_interval.tv_sec = usecs / 1000000;
+    it.it_interval.tv_usec = usecs % 1000000;
+    it.it_value = it.it_interval;
+    return setitimer(ITIMER_PROF, &it, NULL) == 0;
+}
+
+bool ksystem_start_prof_timer(klisp_State *K, int32_t usecs)
+{
+    UNUSED(K);
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = prof_handler;
+    sigemptyset(&sa.sa_mask);
+#ifdef SA_RESTART
+    /* don't interrupt reads & writes on ports */
+    sa.sa_flags = SA_RESTART;
+#endif
+    if (sigaction(SIGPROF, &sa, NULL) != 0)
+        return false;
+    return set_prof_timer(usecs);
+}
+
+void ksystem_stop_prof_timer(klisp_State *K)
+{
+    UNUSED(K);
+    set_prof_timer(0);
+}
+
+/* port readiness */
+
+/* true if there is input already read from the fd but still in the
+   stdio buffer (or pushed back with ungetc), poll doesn't know about it.
+   There's no standard way to ask this, so look in the FILE struct of
+   the libcs where its layout is known. Elsewhere this may say that a 
+   port isn't ready when it is, but never the other way around */
+static bool file_has_buffered_input(FILE *file)
+{
+#if defined(__GLIBC__)
+    return file->_IO_read_ptr < file->_IO_read_end;
+#elif defined(__APPLE__) || defined(__FreeBSD__) || defined(__NetBSD__) \
+    || defined(__OpenBSD__) || defined(__DragonFly__)
+    return file->_r > 0;
+#else
+    UNUSED(file);
+    return false;
+#endif
+}
+
+/* fills pfd for polling port, returns true if the port is known to be
+   ready without calling poll (in which case pfd->fd is -1) */
+static bool port_pollfd(TValue port, struct pollfd *pfd)
+{
+    pfd->fd = -1;
+    pfd->events = 0;
+    pfd->revents = 0;
+
+    /* memory ports never block, and closed ports will throw an error */
+    if (!ttisfport(port) || kport_is_closed(port))
+        return true;
+
+    FILE *file = kfport_file(port);
+    if (kport_is_input(port) && (feof(file) || file_has_buffered_input(file)))
+        return true;
+
+    pfd->fd = fileno(file);
+    pfd->events = kport_is_input(port)? POLLIN : POLLOUT;
+    return false;
+}
+
+bool ksystem_port_ready(klisp_State *K, TValue port)
+{
+    UNUSED(K);
+    struct pollfd pfd;
+    if (port_pollfd(port, &pfd))
+        return true;
+
+    /* this doesn't wait, so there's no need to release the GIL */
+    int ret;
+    while ((ret = poll(&pfd, 1, 0)) < 0 && errno == EINTR)
+        ;
+    /* POLLHUP, POLLERR & POLLNVAL also count as ready: the read or write
+       won't block, it will just return eof or report the error. If poll 
+       itself failed, do the same */
+    return ret != 0;
+}
+
+/* GC: Assumes ports is rooted */
+TValue ksystem_wait_ports(klisp_State *K, TValue ports, int32_t n, 
+                          int32_t msecs)
+{
+    struct pollfd *pfds = klispM_newvector(K, n, struct pollfd);
+    bool some_ready = false;
+    TValue tail = ports;
+    for (int32_t i = 0; i < n; ++i, tail = kcdr(tail))
+        some_ready |= port_pollfd(kcar(tail), &pfds[i]);
+
+    /* if some port is already ready only collect the others that are 
+       ready too */
+    int32_t timeout = some_ready? 0 : msecs;
+    uint64_t deadline = ksystem_current_usecs(K) + 
+        (uint64_t) (msecs < 0? 0 : msecs) * 1000;
+
+    /* LOCK: only a single lock should be acquired */
+    klisp_unlock(K);
+    int ret;
+    while ((ret = poll(pfds, n, timeout)) < 0 && errno == EINTR) {
+        /* e.g. the profiler timer, poll isn't restarted by SA_RESTART */
+        if (timeout > 0) {
+            uint64_t now = ksystem_current_usecs(K);
+            timeout = now >= deadline? 0 : (int32_t) ((deadline - now) / 1000);
+        }
+    }
+    int errnum = errno;
+    klisp_lock(K);
+
+    if (ret < 0) {
+        klispM_freearray(K, pfds, n, struct pollfd);
+        errno = errnum;
+        klispE_throw_errno_simple(K, "poll");
+        return KINERT;
+    }
+
+    TValue res = kcons(K, KNIL, KNIL);
+    krooted_vars_push(K, &res);
+    TValue last_pair = res;
+    tail = ports;
+    for (int32_t i = 0; i < n; ++i, tail = kcdr(tail)) {
+        if (pfds[i].fd < 0 || pfds[i].revents != 0) {
+            TValue new_pair = kcons(K, kcar(tail), KNIL);
+            kset_cdr(last_pair, new_pair);
+            last_pair = new_pair;
+        }
+    }
+    klispM_freearray(K, pfds, n, struct pollfd);
+    krooted_vars_pop(K);
+    return kcdr(res);
+}
+
+/* pipes & socket pairs */
+
+/* opens a FILE for each fd, even fds are for reading and odd ones for
+   writing. On error closes all fds (and files) and returns false with
+   errno set */
+static bool fdopen_all(int *fds, FILE **files, int32_t n, bool binaryp)
+{
+    for (int32_t i = 0; i < n; ++i) {
+        const char *mode = (i % 2 == 0)? (binaryp? "rb" : "r") :
+            (binaryp? "wb" : "w");
+        files[i] = fdopen(fds[i], mode);
+        if (files[i] == NULL) {
+            int errnum = errno;
+            for (int32_t j = 0; j < n; ++j) {
+                if (j < i)
+                    fclose(files[j]);
+                else
+                    close(fds[j]);
+            }
+            errno = errnum;
+            return false;
+        }
+    }
+    return true;
+}
+
+/* returns the list (input-port output-port) for files[0] & files[1] */
+static TValue make_fd_ports(klisp_State *K, FILE **files, const char *name, 
+                            bool binaryp)
+{
+    /* writing to a pipe or socket with no reader should be an error on 
+       the port, not kill the interpreter */
+    signal(SIGPIPE, SIG_IGN);
+
+    TValue filename = kstring_new_b_imm(K, name);
+    krooted_tvs_push(K, filename);
+    TValue in = kmake_std_fport(K, filename, false, binaryp, files[0]);
+    krooted_tvs_push(K, in);
+    TValue out = kmake_std_fport(K, filename, true, binaryp, files[1]);
+    krooted_tvs_push(K, out);
+    TValue res = klist(K, 2, in, out);
+    krooted_tvs_pop(K);
+    krooted_tvs_pop(K);
+    krooted_tvs_pop(K);
+    return res;
+}
+
+TValue ksystem_make_pipe(klisp_State *K, bool binaryp)
+{
+    int fds[2];
+    FILE *files[2];
+    if (pipe(fds) != 0) {
+        klispE_throw_errno_simple(K, "pipe");
+        return KINERT;
+    } else if (!fdopen_all(fds, files, 2, binaryp)) {
+        klispE_throw_errno_simple(K, "fdopen");
+        return KINERT;
+    }
+    return make_fd_ports(K, files, "*PIPE*", binaryp);
+}
+
+TValue ksystem_make_socket_pair(klisp_State *K, bool binaryp)
+{
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) != 0) {
+        klispE_throw_errno_simple(K, "socketpair");
+        return KINERT;
+    }
+    /* each end is used by an input and an output port, and each port 
+       closes its own fd */
+    int fds[4] = { sv[0], dup(sv[0]), sv[1], dup(sv[1]) };
+    if (fds[1] < 0 || fds[3] < 0) {
+        int errnum = errno;
+        for (int32_t i = 0; i < 4; ++i) {
+            if (fds[i] >= 0)
+                close(fds[i]);
+        }
+        errno = errnum;
+        klispE_throw_errno_simple(K, "dup");
+        return KINERT;
+    }
+
+    FILE *files[4];
+    if (!fdopen_all(fds, files, 4, binaryp)) {
+        klispE_throw_errno_simple(K, "fdopen");
+        return KINERT;
+    }
+    TValue end1 = make_fd_ports(K, files, "*SOCKET*", binaryp);
+    krooted_tvs_push(K, end1);
+    TValue end2 = make_fd_ports(K, files + 2, "*SOCKET*", binaryp);
+    krooted_tvs_push(K, end2);
+    TValue res = klist(K, 2, end1, end2);
+    krooted_tvs_pop(K);
+    krooted_tvs_pop(K);
+    return res;
+}
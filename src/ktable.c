@@ -48,7 +48,7 @@
 
 #define hashpow2(t,n)         (gnode(t, lmod((n), sizenode(t))))
   
-#define hashstr(t,str)  hashpow2(t, (str)->hash)
+#define hashstr(t,str)  hashpow2(t, kstring_hash(gc2str(str)))
 #define hashsym(t,sym)  hashpow2(t, (sym)->hash)
 #define hashboolean(t,p)           hashpow2(t, p? 1 : 0)
 
@@ -382,12 +382,15 @@ static void rehash (klisp_State *K, Table *t, const TValue ek) {
 ** }=============================================================
 */
 
-/* wflags should be either or both of K_FLAG_WEAK_KEYS or K_FLAG_WEAK VALUES */
+/* wflags should be either or both of K_FLAG_WEAK_KEYS or K_FLAG_WEAK VALUES,
+   or K_FLAG_WEAK_KEYS | K_FLAG_EPHEMERON */
 TValue klispH_new (klisp_State *K, int32_t narray, int32_t nhash, 
                    int32_t wflags)  
 {
-    klisp_assert((wflags & (K_FLAG_WEAK_KEYS | K_FLAG_WEAK_VALUES)) ==
-                 wflags);
+    klisp_assert((wflags & (K_FLAG_WEAK_KEYS | K_FLAG_WEAK_VALUES |
+                            K_FLAG_EPHEMERON)) == wflags);
+    klisp_assert((wflags & K_FLAG_EPHEMERON) == 0 || 
+                 wflags == (K_FLAG_WEAK_KEYS | K_FLAG_EPHEMERON));
     Table *t = klispM_new(K, Table);
     klispC_link(K, (GCObject *) t, K_TTABLE, wflags);
     /* temporary values (kept only if some malloc fails) */
@@ -491,7 +494,8 @@ const TValue *klispH_getstr (Table *t, String *key) {
     klisp_assert(kstring_immutablep(gc2str(key)));
     Node *n = hashstr(t, key);
     do {  /* check whether `key' is somewhere in the chain */
-        if (ttisstring(gkey(n)->this) && tv2str(gkey(n)->this) == key)
+        if (ttisstring(gkey(n)->this) && 
+            kstring_imm_eqp(gkey(n)->this, gc2str(key)))
             return &gval(n);  /* that's it */
         else n = gnext(n);
     } while (n);
@@ -27,6 +27,7 @@
 #include "kpair.h"
 #include "kstring.h"
 #include "kbytevector.h"
+#include "kslice.h"
 #include "ksymbol.h"
 #include "kkeyword.h"
 #include "kerror.h"
@@ -201,20 +202,20 @@ int ktok_ggetc(klisp_State *K)
         /* mport */
         if (kport_is_binary(port)) {
             /* bytevector port */
-            if (kmport_off(port) >= kbytevector_size(kmport_buf(port))) {
+            if (kmport_off(port) >= kbvview_size(kmport_buf(port))) {
                 K->ktok_seen_eof = true;
                 return EOF;
             }
-            int chi = kbytevector_buf(kmport_buf(port))[kmport_off(port)];
+            int chi = kbvview_buf(kmport_buf(port))[kmport_off(port)];
             ++kmport_off(port);
             return chi;
         } else {
             /* string port */
-            if (kmport_off(port) >= kstring_size(kmport_buf(port))) {
+            if (kmport_off(port) >= kstrview_size(kmport_buf(port))) {
                 K->ktok_seen_eof = true;
                 return EOF;
             }
-            int chi = kstring_buf(kmport_buf(port))[kmport_off(port)];
+            int chi = kstrview_buf(kmport_buf(port))[kmport_off(port)];
             ++kmport_off(port);
             return chi;
         }
@@ -302,6 +303,24 @@ TValue ktok_get_source_info(klisp_State *K)
     return res;
 }
 
+/* This is the source info that is saved in the objects read, it is 
+   nil when reading without source info and uses the compact form
+   (see kstate.h) whenever possible */
+TValue ktok_get_obj_source_info(klisp_State *K)
+{
+    if (!K->read_sip)
+        return KNIL;
+
+    int32_t line = K->ktok_source_info.saved_line;
+    int32_t col = K->ktok_source_info.saved_col;
+    if (line < 0 || line > KSI_MAX_LINE || col < 0 || col > KSI_MAX_COL)
+        return ktok_get_source_info(K);
+
+    /* the filename is rooted in the port */
+    return kcons(K, K->ktok_source_info.filename, 
+                 i2tv((line << KSI_COL_BITS) | col));
+}
+
 void ktok_set_source_info(klisp_State *K, TValue filename, int32_t line,
                           int32_t col)
 {
@@ -620,7 +639,7 @@ TValue ktok_read_maybe_signed_numeric(klisp_State *K)
         ks_tbadd(K, ch);
         ks_tbadd(K, '\0');
         /* save the source info in the symbol */
-        TValue si = ktok_get_source_info(K);
+        TValue si = ktok_get_obj_source_info(K);
         krooted_tvs_push(K, si); /* will be popped by throw */
         TValue new_sym = ksymbol_new_bs(K, ks_tbget_buffer(K), 1, si);
         krooted_tvs_pop(K); /* already in symbol */
@@ -1136,7 +1155,7 @@ TValue ktok_read_identifier_or_dot(klisp_State *K, bool keywordp)
     if (keywordp) {
         new_obj = kkeyword_new_bs(K, ks_tbget_buffer(K), i);
     } else {
-        TValue si = ktok_get_source_info(K);
+        TValue si = ktok_get_obj_source_info(K);
         krooted_tvs_push(K, si); /* will be popped by throw */
         new_obj = ksymbol_new_bs(K, ks_tbget_buffer(K), i, si);
         krooted_tvs_pop(K); /* already in symbol */
@@ -1210,7 +1229,7 @@ TValue ktok_read_bar_identifier(klisp_State *K, bool keywordp)
     if (keywordp) {
         new_obj = kkeyword_new_bs(K, ks_tbget_buffer(K), i);
     } else {
-        TValue si = ktok_get_source_info(K);
+        TValue si = ktok_get_obj_source_info(K);
         krooted_tvs_push(K, si); /* will be popped by throw */
         new_obj = ksymbol_new_bs(K, ks_tbget_buffer(K), i, si);
         krooted_tvs_pop(K); /* already in symbol */
@@ -21,6 +21,7 @@ TValue ktok_read_token(klisp_State *K);
 
 /* return a fresh ilist of the form (filename line . col) */
 TValue ktok_get_source_info(klisp_State *K);
+TValue ktok_get_obj_source_info(klisp_State *K);
 void ktok_set_source_info(klisp_State *K, TValue filename, int32_t line,
                           int32_t col);
 
@@ -65,3 +65,141 @@ bool kmutable_vectorp(TValue obj)
 {
     return ttisvector(obj) && kis_mutable(obj);
 }
+
+bool kgvectorp(TValue obj)
+{
+    return ttisgvector(obj);
+}
+
+/*
+** Growable vectors
+*/
+#define gvbufsize(cap_) (sizeof(Vector) + sizeof(TValue) * (cap_))
+
+TValue kgvector_new(klisp_State *K, uint32_t capacity)
+{
+    GVector *new_gv = klispM_new(K, GVector);
+
+    /* header + gc_fields */
+    klispC_link(K, (GCObject *) new_gv, K_TGVECTOR, 0);
+
+    /* growable vector specific fields */
+    new_gv->capacity = 0;
+    new_gv->buf = NULL;
+
+    TValue res = gc2gvector(new_gv);
+    if (capacity > 0) {
+        krooted_tvs_push(K, res);
+        kgvector_reserve(K, res, capacity);
+        krooted_tvs_pop(K);
+    }
+    return res;
+}
+
+void klispGV_free(klisp_State *K, GVector *v)
+{
+    if (v->buf != NULL)
+        klispM_freemem(K, v->buf, gvbufsize(v->capacity));
+    klispM_free(K, v);
+}
+
+/* GC: v should be rooted */
+/* NOTE: the buffer stays in v while reallocating: if the gc runs,
+   it does so before the block is moved, and the elements in use are
+   marked from the old block */
+static void set_capacity(klisp_State *K, TValue v, uint32_t capacity)
+{
+    GVector *gv = tv2gvector(v);
+
+    if (capacity == 0) {
+        if (gv->buf != NULL)
+            klispM_freemem(K, gv->buf, gvbufsize(gv->capacity));
+        gv->buf = NULL;
+        gv->capacity = 0;
+        return;
+    }
+
+    if (capacity > (SIZE_MAX - sizeof(Vector)) / sizeof(TValue) ||
+        capacity > INT32_MAX) {
+        klispM_toobig(K);
+        return;
+    }
+
+    Vector *buf = klispM_realloc_(K, gv->buf, gv->buf == NULL? 0 : 
+                                  gvbufsize(gv->capacity), 
+                                  gvbufsize(capacity));
+    if (gv->buf == NULL)
+        buf->sizearray = 0;
+    gv->buf = buf;
+    gv->capacity = capacity;
+}
+
+/* GC: v should be rooted */
+void kgvector_reserve(klisp_State *K, TValue v, uint32_t capacity)
+{
+    if (capacity > kgvector_capacity(v))
+        set_capacity(K, v, capacity);
+}
+
+/* GC: v & obj should be rooted */
+void kgvector_push(klisp_State *K, TValue v, TValue obj)
+{
+    GVector *gv = tv2gvector(v);
+    uint32_t size = kgvector_size(v);
+
+    if (size == gv->capacity) {
+        /* grow geometrically, so that pushing n elements is O(n) */
+        uint64_t cap = ((uint64_t) gv->capacity) * 2;
+        if (cap < MINGVECTORSIZE)
+            cap = MINGVECTORSIZE;
+        if (cap > INT32_MAX) {
+            if (size == INT32_MAX) {
+                klispM_toobig(K);
+                return;
+            }
+            cap = INT32_MAX;
+        }
+        set_capacity(K, v, (uint32_t) cap);
+    }
+    gv->buf->array[size] = obj;
+    gv->buf->sizearray = size + 1;
+}
+
+/* GC: v should be rooted */
+void kgvector_shrink(klisp_State *K, TValue v)
+{
+    uint32_t size = kgvector_size(v);
+    if (size < kgvector_capacity(v))
+        set_capacity(K, v, size);
+}
+
+/* GC: v should be rooted */
+TValue kgvector_to_vector(klisp_State *K, TValue v)
+{
+    GVector *gv = tv2gvector(v);
+    uint32_t size = kgvector_size(v);
+
+    if (size == 0) {
+        set_capacity(K, v, 0);
+        return G(K)->empty_vector;
+    }
+
+    /* give back the unused part, without copying unless the allocator
+       decides to move the block */
+    kgvector_shrink(K, v);
+
+    /* now detach the buffer and make it a regular vector, there are
+       no allocations in between */
+    Vector *new_vector = gv->buf;
+    gv->buf = NULL;
+    gv->capacity = 0;
+
+    /* header + gc_fields */
+    klispC_link(K, (GCObject *) new_vector, K_TVECTOR, 0);
+
+    /* vector specific fields */
+    new_vector->mark = KFALSE;
+    klisp_assert(new_vector->sizearray == size);
+
+    return gc2vector(new_vector);
+}
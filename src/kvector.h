@@ -21,6 +21,28 @@ TValue kvector_new_bs_g(klisp_State *K, bool m,
 bool kvectorp(TValue obj);
 bool kimmutable_vectorp(TValue obj);
 bool kmutable_vectorp(TValue obj);
+bool kgvectorp(TValue obj);
+
+/* growable vectors */
+
+TValue kgvector_new(klisp_State *K, uint32_t capacity);
+void klispGV_free(klisp_State *K, GVector *v);
+
+/* GC: v should be rooted */
+void kgvector_reserve(klisp_State *K, TValue v, uint32_t capacity);
+/* GC: v & obj should be rooted */
+void kgvector_push(klisp_State *K, TValue v, TValue obj);
+/* GC: v should be rooted */
+void kgvector_shrink(klisp_State *K, TValue v);
+/* GC: v should be rooted */
+/* this hands over the buffer to the new vector and leaves v empty */
+TValue kgvector_to_vector(klisp_State *K, TValue v);
+
+#define kgvector_capacity(v_) (tv2gvector(v_)->capacity)
+#define kgvector_size(v_) ({ Vector *b_ = tv2gvector(v_)->buf;  \
+            b_ == NULL? 0 : b_->sizearray; })
+/* only valid if the vector isn't empty */
+#define kgvector_buf(v_) (tv2gvector(v_)->buf->array)
 
 /* some macros to access the parts of vectors */
 
@@ -27,6 +27,7 @@
 #include "kport.h"
 #include "kenvironment.h"
 #include "kbytevector.h"
+#include "kslice.h"
 #include "kvector.h"
 #include "ktoken.h" /* for identifier checking */
 
@@ -167,12 +168,12 @@ void kw_print_double(klisp_State *K, TValue tv_double)
 ** and escapes backslashes, double quotes,
 ** and non printable chars (including NULL). 
 ** if displayp it doesn't include surrounding quotes and just
-** converts non-printable characters to spaces
+** converts non-printable characters to spaces.
+** The chars are given as buffer & size so that string slices can be 
+** printed too, and the buffer isn't modified (it may be shared).
 */
-void kw_print_string(klisp_State *K, TValue str)
+static void kw_print_chars(klisp_State *K, char *buf, int size)
 {
-    int size = kstring_size(str);
-    char *buf = kstring_buf(str);
     char *ptr = buf;
     int i = 0;
 
@@ -191,10 +192,8 @@ void kw_print_string(klisp_State *K, TValue str)
 
         /* NOTE: this work even if ptr == buf (which can only happen the 
            first or last time) */
-        char ch = *ptr;
-        *ptr = '\0';
-        kw_printf(K, "%s", buf);
-        *ptr = ch;
+        kw_printf(K, "%.*s", (int) (ptr - buf), buf);
+        char ch;
 
         for(; i < size && (*ptr == '\0' || (*ptr < 32 || *ptr >= 127) ||
                            (!K->write_displayp && 
@@ -240,6 +239,11 @@ void kw_print_string(klisp_State *K, TValue str)
         kw_printf(K, "\"");
 }
 
+void kw_print_string(klisp_State *K, TValue str)
+{
+    kw_print_chars(K, kstring_buf(str), kstring_size(str));
+}
+
 /*
 ** Helper for printing symbols & keywords.
 ** If symbol is not a regular identifier it
@@ -417,8 +421,6 @@ void kw_print_name(klisp_State *K, TValue obj)
 /* Assumes obj has a si */
 void kw_print_si(klisp_State *K, TValue obj)
 {
-    /* should be an improper list of 2 pairs,
-       with a string and 2 fixints */
     TValue si = kget_source_info(K, obj);
     kw_printf(K, " @ ");
     /* this is a hack, would be better to change the interface of 
@@ -426,9 +428,9 @@ void kw_print_si(klisp_State *K, TValue obj)
     bool saved_displayp = K->write_displayp; 
     K->write_displayp = true; /* avoid "s and escapes */
 
-    TValue str = kcar(si);
-    int32_t row = ivalue(kcadr(si));
-    int32_t col = ivalue(kcddr(si));
+    TValue str = ksi_filename(si);
+    int32_t row = ksi_line(si);
+    int32_t col = ksi_col(si);
     kw_print_string(K, str);
     kw_printf(K, " (line: %d, col: %d)", row, col);
 
@@ -752,6 +754,25 @@ void kwrite_scalar(klisp_State *K, TValue obj)
 #endif
         kw_printf(K, "]");
         break;
+    case K_TSTRBUILDER:
+        kw_printf(K, "#[string-builder]");
+        break;
+    case K_TGVECTOR:
+        kw_printf(K, "#[growable-vector]");
+        break;
+    case K_TCHANNEL:
+        kw_printf(K, "#[channel]");
+        break;
+    case K_TFUTURE:
+        kw_printf(K, "#[future]");
+        break;
+    case K_TSLICE:
+        /* slices are printed like the strings or bytevectors they view */
+        if (ttisstrslice(obj))
+            kw_print_chars(K, kstrview_buf(obj), kstrview_size(obj));
+        else
+            kw_printf(K, "#[bytevector]");
+        break;
     default:
         /* shouldn't happen */
         kwrite_error(K, "unknown object type");